@@ -0,0 +1,85 @@
+
+#include "ParticleRenderer.h"
+
+// the batch arrays are handed to GL as is
+//
+static_assert(sizeof(Vec3) == sizeof(glm::vec3), "Vec3 must match glm::vec3");
+static_assert(sizeof(FloatColor) == sizeof(ofFloatColor), "FloatColor must match ofFloatColor");
+
+// point sprite shaders (GLSL 1.20 to match the fixed function GL renderer
+// the rest of the app uses).  The vertex shader turns the world space
+// radius into a pixel size using the projection's focal length.
+//
+static const string vertexShader = "#version 120\n" STRINGIFY(
+    attribute float radius;
+    uniform float viewportHeight;
+    void main() {
+        vec4 eye = gl_ModelViewMatrix * gl_Vertex;
+        gl_Position = gl_ProjectionMatrix * eye;
+        gl_PointSize = max(1.0, viewportHeight * gl_ProjectionMatrix[1][1] * radius / -eye.z);
+        gl_FrontColor = gl_Color;
+    }
+);
+
+static const string fragmentShader = "#version 120\n" STRINGIFY(
+    void main() {
+        vec2 p = gl_PointCoord * 2.0 - 1.0;
+        float r2 = dot(p, p);
+        if (r2 > 1.0) discard;
+        float shade = 0.4 + 0.6 * sqrt(1.0 - r2);    // fake sphere lighting
+        gl_FragColor = vec4(gl_Color.rgb * shade, gl_Color.a);
+    }
+);
+
+ParticleRenderer::ParticleRenderer() {
+    allocated = 0;
+    uploaded = 0;
+    radiusAttribute = -1;
+    bSetup = false;
+}
+
+// compile the sprite shader, needs a GL context so it is done on first draw
+//
+void ParticleRenderer::setup() {
+    shader.setupShaderFromSource(GL_VERTEX_SHADER, vertexShader);
+    shader.setupShaderFromSource(GL_FRAGMENT_SHADER, fragmentShader);
+    shader.bindDefaults();
+    shader.linkProgram();
+    radiusAttribute = shader.getAttributeLocation("radius");
+    bSetup = true;
+}
+
+// stream packed data into the vbo.  storage is (re)allocated only when the
+// count outgrows it, otherwise the existing buffers are overwritten in place.
+//
+void ParticleRenderer::upload(const ParticleBatch &batch) {
+    if (!bSetup) setup();
+    int count = batch.count;
+    uploaded = count;
+    if (count == 0) return;
+    const glm::vec3 *positions = (const glm::vec3 *)&batch.positions[0];
+    const ofFloatColor *colors = (const ofFloatColor *)&batch.colors[0];
+    if (count > allocated) {
+        allocated = batch.positions.size();
+        vbo.setVertexData(positions, allocated, GL_STREAM_DRAW);
+        vbo.setColorData(colors, allocated, GL_STREAM_DRAW);
+        if (radiusAttribute >= 0)
+            vbo.setAttributeData(radiusAttribute, &batch.radii[0], 1, allocated, GL_STREAM_DRAW);
+    }
+    else {
+        vbo.updateVertexData(positions, count);
+        vbo.updateColorData(colors, count);
+        if (radiusAttribute >= 0)
+            vbo.updateAttributeData(radiusAttribute, &batch.radii[0], count);
+    }
+}
+
+void ParticleRenderer::draw() {
+    if (uploaded == 0 || !bSetup) return;
+    shader.begin();
+    shader.setUniform1f("viewportHeight", ofGetViewportHeight());
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    vbo.draw(GL_POINTS, 0, uploaded);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    shader.end();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleBatch.h"
+
+//  Draws a whole particle cloud with one call.
+//
+//  The particles are packed into a ParticleBatch (see core), upload()
+//  streams the batch into a single vertex buffer that is only reallocated
+//  when the particle count outgrows it, and draw() renders the buffer as
+//  shaded point sprites sized by radius in one draw call.  A batch packed
+//  elsewhere (e.g. by the simulation thread) can be drawn directly.
+//
+class ParticleRenderer {
+public:
+    ParticleRenderer();
+    void upload() { upload(batch); }
+    void upload(const ParticleBatch &b);
+    void draw();
+    void draw(const vector<Particle> &particles) {
+        batch.pack(particles);
+        upload();
+        draw();
+    }
+    void draw(const ParticleBatch &b) {
+        upload(b);
+        draw();
+    }
+
+    ParticleBatch batch;
+    int allocated;      // particles the vbo has room for
+    int uploaded;       // particles in the vbo from the last upload
+
+private:
+    void setup();
+    ofVbo vbo;
+    ofShader shader;
+    int radiusAttribute;
+    bool bSetup;
+};
@@ -117,9 +117,9 @@ void ofApp::draw() {
 				}
 				ofVec3f min = rover.getSceneMin() + rover.getPosition();
 				ofVec3f max = rover.getSceneMax() + rover.getPosition();
-				Octree::drawBox(Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z)));
+				Octree::drawBox(Box(Vec3(min.x, min.y, min.z), Vec3(max.x, max.y, max.z)));
 			/*	ofVec3f p = rover.getPosition();
-				Vector3 pos = Vector3(p.x, p.y, p.z);
+				Vec3 pos = Vec3(p.x, p.y, p.z);
 				Box box = Octree::meshBounds(rover.getMesh(0));
 				Octree::drawBox(Box(box.min() + pos, box.max() + pos));*/
 			}
@@ -309,8 +309,8 @@ bool ofApp::raySelectWithOctree(ofVec3f &pointRet) {
 	ofVec3f rayPoint = cam.screenToWorld(mouse);
 	ofVec3f rayDir = rayPoint - cam.getPosition();
 	rayDir.normalize();
-	Ray ray = Ray(Vector3(rayPoint.x, rayPoint.y, rayPoint.z),
-		Vector3(rayDir.x, rayDir.y, rayDir.z));
+	Ray ray = Ray(Vec3(rayPoint.x, rayPoint.y, rayPoint.z),
+		Vec3(rayDir.x, rayDir.y, rayDir.z));
 //	float t1 = ofGetElapsedTimeMicros();
 	pointSelected = octree.intersect(ray, octree.root, selectedNode);
 //	float t2 = ofGetElapsedTimeMicros();
@@ -0,0 +1,136 @@
+
+#include "SimBridge.h"
+
+// copy an ofMesh into the core mesh type (positions, normals, indices)
+//
+Mesh toSimMesh(const ofMesh &mesh) {
+    Mesh m;
+    int n = mesh.getNumVertices();
+    m.vertices.resize(n);
+    for (int i = 0; i < n; i++)
+        m.vertices[i] = toSim(mesh.getVertex(i));
+    if (mesh.getNumNormals() == n) {
+        m.normals.resize(n);
+        for (int i = 0; i < n; i++)
+            m.normals[i] = toSim(mesh.getNormal(i));
+    }
+    m.indices.assign(mesh.getIndices().begin(), mesh.getIndices().end());
+    return m;
+}
+
+//draw a box from a "Box" class
+//
+void drawBox(const Box &box) {
+	Vec3 size = box.max() - box.min();
+	ofVec3f p = toOf(box.center());
+	float w = size.x;
+	float h = size.y;
+	float d = size.z;
+	ofDrawBox(p, w, h, d);
+}
+
+void drawOctree(const TreeNode & node, int numLevels, int level) {
+    if (level >= numLevels)
+        return;
+    switch (level){
+        case 0:
+            ofSetColor(ofColor::red);
+            break;
+        case 1:
+            ofSetColor(ofColor::orange);
+            break;
+        case 2:
+            ofSetColor(ofColor::yellow);
+            break;
+        case 3:
+            ofSetColor(ofColor::green);
+            break;
+        case 4:
+            ofSetColor(ofColor::blue);
+            break;
+        case 5:
+            ofSetColor(ofColor::darkBlue);
+            break;
+        case 6:
+            ofSetColor(ofColor::violet);
+            break;
+        case 7:
+            ofSetColor(ofColor::white);
+            break;
+        case 8:
+            ofSetColor(ofColor::pink);
+            break;
+        case 9:
+            ofSetColor(ofColor::purple);
+            break;
+        default:
+            ofSetColor(ofColor::cyan);
+            break;
+    }
+    drawBox(node.box);
+    level++;
+    for(int i = 0; i < node.children.size(); i++){
+        drawOctree(node.children[i], numLevels, level);
+    }
+}
+
+void drawLeafNodes(const TreeNode & node) {
+    if(node.children.size() == 0){
+        drawBox(node.box);
+    }
+    else{
+        for(int i = 0; i < node.children.size(); i++){
+            drawLeafNodes(node.children[i]);
+        }
+    }
+}
+
+void drawParticle(const Particle &particle) {
+    ofSetColor(toOf(particle.color));
+    ofDrawSphere(toOf(particle.position), particle.radius);
+}
+
+//  draw the particle cloud, in one call if a renderer is given
+//
+void drawParticles(const ParticleSystem &sys, ParticleRenderer *renderer) {
+    if (renderer) {
+        renderer->draw(sys.particles);
+        return;
+    }
+    for (int i = 0; i < sys.particles.size(); i++) {
+        drawParticle(sys.particles[i]);
+    }
+}
+
+void drawEmitter(const ParticleEmitter &emitter, ParticleRenderer *renderer) {
+    if (emitter.visible) {
+        ofVec3f position = toOf(emitter.getPosition());
+        float radius = emitter.radius;
+        switch (emitter.type) {
+            case DirectionalEmitter:
+                ofDrawSphere(position, radius/10);  // just draw a small sphere for point emitters
+                break;
+            case SphereEmitter:
+                ofDrawCircle(position, radius/10);
+                break;
+            case RadialEmitter:
+                ofDrawSphere(position, radius/10);  // just draw a small sphere as a placeholder
+                break;
+            case DiscEmitter:
+                ofDrawSphere(position, radius/10);  // just draw a small sphere as a placeholder
+                break;
+            default:
+                break;
+        }
+    }
+    drawParticles(*emitter.sys, renderer);
+}
+
+// lander and exhaust as captured by the simulation pipeline
+//
+void drawFrame(const LanderFrame &frame, ParticleRenderer *exhaustRenderer) {
+    for (int i = 0; i < frame.lander.size(); i++) {
+        drawParticle(frame.lander[i]);
+    }
+    exhaustRenderer->draw(frame.exhaust);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Vec3.h"
+#include "Color.h"
+#include "Mesh.h"
+#include "Clock.h"
+#include "box.h"
+#include "Octree.h"
+#include "Particle.h"
+#include "ParticleSystem.h"
+#include "ParticleEmitter.h"
+#include "ParticleRenderer.h"
+#include "SimPipeline.h"
+
+//  openFrameworks side of the simulation core.
+//
+//  The core (src/core) has no openFrameworks dependency; everything that
+//  needs OF types, time or drawing lives here: conversions between the core
+//  math types and ofVec3f/ofColor/ofMesh, a Clock backed by the OF timer,
+//  and the draw routines that used to be members of the core classes.
+//
+
+inline ofVec3f toOf(const Vec3 &v) { return ofVec3f(v.x, v.y, v.z); }
+inline Vec3 toSim(const ofVec3f &v) { return Vec3(v.x, v.y, v.z); }
+inline Vec3 toSim(const glm::vec3 &v) { return Vec3(v.x, v.y, v.z); }
+inline ofColor toOf(const Color &c) { return ofColor(c.r, c.g, c.b, c.a); }
+
+Mesh toSimMesh(const ofMesh &mesh);
+
+void drawBox(const Box &box);
+void drawOctree(const TreeNode &node, int numLevels, int level);
+void drawLeafNodes(const TreeNode &node);
+void drawParticle(const Particle &particle);
+void drawParticles(const ParticleSystem &sys, ParticleRenderer *renderer = NULL);
+void drawEmitter(const ParticleEmitter &emitter, ParticleRenderer *renderer = NULL);
+void drawFrame(const LanderFrame &frame, ParticleRenderer *exhaustRenderer);
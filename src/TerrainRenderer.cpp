@@ -0,0 +1,55 @@
+#include "TerrainRenderer.h"
+
+// chunk vertex arrays are handed to GL as is
+//
+static_assert(sizeof(Vec3) == sizeof(glm::vec3), "Vec3 must match glm::vec3");
+static_assert(sizeof(unsigned int) == sizeof(ofIndexType), "chunk indices must match ofIndexType");
+
+TerrainRenderer::TerrainRenderer() {
+    triangles = 0;
+    bBaked = false;
+}
+
+// needs a GL context, so it runs on the main thread once the loader has
+// built the chunks
+//
+void TerrainRenderer::upload(const TerrainChunks &chunks) {
+    buffers.clear();
+    buffers.resize(chunks.chunks.size());
+    bBaked = false;
+    vector<ofIndexType> indices;
+    vector<ofFloatColor> colors;
+    for (int c = 0; c < chunks.chunks.size(); c++) {
+        const TerrainChunk &chunk = chunks.chunks[c];
+        ChunkBuffer &buffer = buffers[c];
+        indices.clear();
+        for (int l = 0; l < chunk.indices.size(); l++) {
+            buffer.offsets.push_back(indices.size());
+            buffer.counts.push_back(chunk.indices[l].size());
+            indices.insert(indices.end(), chunk.indices[l].begin(), chunk.indices[l].end());
+        }
+        if (indices.empty()) continue;
+        buffer.vbo.setVertexData((const glm::vec3 *)&chunk.vertices[0], chunk.vertices.size(), GL_STATIC_DRAW);
+        buffer.vbo.setNormalData((const glm::vec3 *)&chunk.normals[0], chunk.normals.size(), GL_STATIC_DRAW);
+        buffer.vbo.setIndexData(&indices[0], indices.size(), GL_STATIC_DRAW);
+        if (chunk.shade.size() == chunk.vertices.size()) {
+            colors.clear();
+            for (int v = 0; v < chunk.shade.size(); v++)
+                colors.push_back(ofFloatColor(chunk.shade[v], chunk.shade[v], chunk.shade[v]));
+            buffer.vbo.setColorData(&colors[0], colors.size(), GL_STATIC_DRAW);
+            bBaked = true;
+        }
+    }
+}
+
+void TerrainRenderer::draw(const vector<ChunkDraw> &drawList) {
+    triangles = 0;
+    for (int i = 0; i < drawList.size(); i++) {
+        const ChunkDraw &d = drawList[i];
+        if (d.chunk >= buffers.size()) continue;
+        ChunkBuffer &buffer = buffers[d.chunk];
+        if (d.level >= buffer.counts.size() || buffer.counts[d.level] == 0) continue;
+        buffer.vbo.drawElements(GL_TRIANGLES, buffer.counts[d.level], buffer.offsets[d.level]);
+        triangles += buffer.counts[d.level] / 3;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ofMain.h"
+#include "TerrainChunks.h"
+
+//  Draws the chunked level of detail terrain.
+//
+//  upload() copies every chunk into its own vertex buffer once, with the
+//  triangle lists of all its levels back to back in the index buffer.
+//  draw() takes the list from TerrainChunks::select() and renders each
+//  chunk with one draw call over its selected level's index range, so
+//  changing level costs nothing on the GPU side.  Chunks with a baked
+//  shade get it as vertex colors; with lighting on, OF's color material
+//  multiplies the lit surface by it.
+//
+class TerrainRenderer {
+public:
+    TerrainRenderer();
+    void upload(const TerrainChunks &chunks);
+    void draw(const vector<ChunkDraw> &drawList);
+    bool isReady() const { return !buffers.empty(); }
+    bool isBaked() const { return bBaked; }
+
+    int triangles;      // drawn by the last draw()
+
+private:
+    bool bBaked;
+    class ChunkBuffer {
+    public:
+        ofVbo vbo;
+        vector<int> offsets;    // first index of each level
+        vector<int> counts;     // indices in each level
+    };
+    vector<ChunkBuffer> buffers;
+};
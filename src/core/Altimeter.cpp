@@ -0,0 +1,30 @@
+#include "Altimeter.h"
+#include "Profiler.h"
+
+using namespace std;
+
+Altimeter::Altimeter() {
+    range = 1000;
+    alongVelocity = true;
+    valid = false;
+    agl = 0;
+    normal.set(0, 1, 0);
+    timeToImpact = -1;
+}
+
+bool Altimeter::measure(const Octree &octree, const Vec3 &point, const Vec3 &velocity) {
+    PROFILE_SCOPE("Altimeter::measure");
+    valid = octree.raycast(point, Vec3(0, -1, 0), range, down);
+    agl = valid ? down.distance : 0;
+    ground = valid ? down.point : point;
+    normal = valid ? down.normal : Vec3(0, 1, 0);
+
+    timeToImpact = -1;
+    ahead = RayHit();
+    float speed = velocity.length();
+    if (alongVelocity && speed > 0 && octree.raycast(point, velocity / speed, range, ahead))
+        timeToImpact = ahead.distance / speed;
+    else if (valid && velocity.y < 0)
+        timeToImpact = agl / -velocity.y;
+    return valid;
+}
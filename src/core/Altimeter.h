@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Vec3.h"
+#include "Octree.h"
+
+//  Radar altimeter: terrain relative readouts for the HUD and guidance.
+//
+//  measure() casts one ray straight down from the given point against the
+//  terrain octree and, if alongVelocity and the point is moving, one more
+//  along its velocity.  agl is the distance to the ground below and normal
+//  that ground's face normal.  timeToImpact is the seconds until the point
+//  reaches the terrain at its current velocity: from the velocity ray's
+//  hit if there is one within range, otherwise from the vertical closing
+//  speed over agl, and -1 when it is not closing on the ground at all.
+//
+class Altimeter {
+public:
+    Altimeter();
+    bool measure(const Octree &octree, const Vec3 &point, const Vec3 &velocity);
+
+    float range;            // longest ray cast, mesh units
+    bool alongVelocity;
+
+    bool valid;             // ground found below within range
+    float agl;
+    Vec3 ground;            // point below
+    Vec3 normal;
+    float timeToImpact;
+    RayHit down, ahead;     // the raw ray results
+};
@@ -0,0 +1,39 @@
+
+#include "Clock.h"
+
+static SystemClock systemClock;
+static Clock *defaultClock = &systemClock;
+
+Clock *Clock::getDefault() {
+    return defaultClock;
+}
+
+// install the clock used by systems that were not given one explicitly
+//
+void Clock::setDefault(Clock *c) {
+    defaultClock = c ? c : &systemClock;
+}
+
+SystemClock::SystemClock() {
+    reset();
+}
+
+void SystemClock::reset() {
+    start = last = std::chrono::steady_clock::now();
+    rate = 60;
+}
+
+float SystemClock::elapsedMillis() {
+    std::chrono::duration<float, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+}
+
+// measure the time since the previous tick and smooth it into the rate
+//
+void SystemClock::tick() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<float> d = now - last;
+    last = now;
+    if (d.count() > 0)
+        rate = rate * .9f + (1.0f / d.count()) * .1f;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+
+//  Time source for the simulation.
+//
+//  The core never asks the windowing layer what time it is; particle ages
+//  and integration steps come from a Clock.  The app installs a clock that
+//  forwards to openFrameworks, headless tools use SystemClock (wall time)
+//  or FixedClock (a fixed step that only moves when advanced).
+//
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual float elapsedMillis() = 0;  // ms since the clock was started
+    virtual float frameRate() = 0;      // frames per second, for the step size
+    virtual void reset() {}             // restart elapsed time at 0
+
+    static Clock *getDefault();
+    static void setDefault(Clock *);
+};
+
+//  Wall clock.  Call tick() once per frame to measure the frame rate.
+//
+class SystemClock : public Clock {
+public:
+    SystemClock();
+    float elapsedMillis();
+    float frameRate() { return rate; }
+    void tick();
+    void reset();
+
+private:
+    std::chrono::steady_clock::time_point start, last;
+    float rate;
+};
+
+//  Clock set from outside, for a sim stepped on another thread: the
+//  thread that owns the window samples its timer once per frame and hands
+//  the values over with the step (see SimPipeline), so the sim never calls
+//  into the windowing layer.  reset() restarts elapsed time at the last
+//  sample.
+//
+class SampledClock : public Clock {
+public:
+    SampledClock() : millis(0), rate(60), origin(0) {}
+    float elapsedMillis() { return millis - origin; }
+    float frameRate() { return rate; }
+    void reset() { origin = millis; }
+    void set(float now, float fps) { millis = now; rate = fps; }
+
+private:
+    float millis, rate;
+    float origin;
+};
+
+//  Deterministic clock: time only moves in whole steps of 1 / rate seconds.
+//
+class FixedClock : public Clock {
+public:
+    FixedClock(float rate = 60) : rate(rate), millis(0) {}
+    float elapsedMillis() { return millis; }
+    float frameRate() { return rate; }
+    void advance(int steps = 1) { millis += steps * 1000.0f / rate; }
+    void reset() { millis = 0; }
+
+    float rate;
+    float millis;
+};
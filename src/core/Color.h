@@ -0,0 +1,21 @@
+#pragma once
+
+//  8 bit RGBA color for particles (same layout as ofColor).
+//
+class Color {
+public:
+    unsigned char r, g, b, a;
+
+    Color() : r(255), g(255), b(255), a(255) {}
+    Color(int r, int g, int b, int a = 255) : r(r), g(g), b(b), a(a) {}
+};
+
+//  Float RGBA color, layout compatible with ofFloatColor.
+//
+class FloatColor {
+public:
+    float r, g, b, a;
+
+    FloatColor() : r(1), g(1), b(1), a(1) {}
+    FloatColor(const Color &c) : r(c.r / 255.0f), g(c.g / 255.0f), b(c.b / 255.0f), a(c.a / 255.0f) {}
+};
@@ -0,0 +1,142 @@
+
+#include "FlightRecorder.h"
+#include <fstream>
+#include <chrono>
+#include <string.h>
+
+using namespace std;
+
+// snapshot the sim and start logging its inputs.  the sim is switched to
+// the fixed step and reset to the snapshot so the live flight and any
+// replay start from exactly the same state.
+//
+void FlightRecorder::start(LanderSim &sim) {
+    sim.setFixedStep(true, rate);
+    initial = sim.getState();
+    sim.setState(initial);
+    events.clear();
+    frames = 0;
+    sim.recorder = this;
+    recording = true;
+}
+
+void FlightRecorder::stop(LanderSim &sim) {
+    if (!recording) return;
+    frames = sim.frame;
+    sim.recorder = NULL;
+    sim.setFixedStep(false);
+    recording = false;
+}
+
+void FlightRecorder::record(int frame, LanderControl c, bool pressed) {
+    InputEvent e;
+    e.frame = frame;
+    e.control = c;
+    e.pressed = pressed;
+    events.push_back(e);
+}
+
+static void writeVec(ofstream &out, const Vec3 &v) {
+    out << v.x << " " << v.y << " " << v.z << " ";
+}
+
+static void readVec(ifstream &in, Vec3 &v) {
+    in >> v.x >> v.y >> v.z;
+}
+
+bool FlightRecorder::save(const string &path) const {
+    ofstream out(path.c_str());
+    if (!out) return false;
+    out.precision(9);
+    out << "lander-recording 1\n";
+    out << rate << " " << frames << " " << events.size() << "\n";
+    const LanderState &s = initial;
+    writeVec(out, s.position);
+    writeVec(out, s.velocity);
+    writeVec(out, s.thrust);
+    writeVec(out, s.impulse);
+    writeVec(out, s.engineVelocity);
+    out << s.impulseApplied << " " << s.fuel << " " << s.thrustTime << " " << s.clockMillis << " "
+        << s.collided << " " << s.gameOver << " " << s.engineStarted << " " << s.seed << "\n";
+    for (int i = 0; i < events.size(); i++)
+        out << events[i].frame << " " << events[i].control << " " << events[i].pressed << "\n";
+    return out.good();
+}
+
+bool FlightRecorder::load(const string &path) {
+    ifstream in(path.c_str());
+    string magic;
+    int version, count;
+    in >> magic >> version;
+    if (!in || magic != "lander-recording" || version != 1) return false;
+    in >> rate >> frames >> count;
+    LanderState &s = initial;
+    readVec(in, s.position);
+    readVec(in, s.velocity);
+    readVec(in, s.thrust);
+    readVec(in, s.impulse);
+    readVec(in, s.engineVelocity);
+    in >> s.impulseApplied >> s.fuel >> s.thrustTime >> s.clockMillis
+       >> s.collided >> s.gameOver >> s.engineStarted >> s.seed;
+
+    // an event takes at least "f c p\n" in the file, so a count the rest of
+    // the file can't hold is a corrupt header, not a reason to allocate
+    //
+    streampos here = in.tellg();
+    in.seekg(0, ios::end);
+    streamoff rest = in.tellg() - here;
+    in.seekg(here);
+    if (!in || count < 0 || count > rest / 6) return false;
+    events.resize(count);
+    for (int i = 0; i < count; i++) {
+        int control;
+        in >> events[i].frame >> control >> events[i].pressed;
+        events[i].control = (LanderControl)control;
+    }
+    recording = false;
+    return !in.fail();
+}
+
+static uint64_t hashBytes(uint64_t h, const void *data, int n) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (int i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// feed a recording back through the sim at its fixed step, as fast as
+// possible, timing every frame.  the trajectory hash only matches another
+// run if every lander position was bit identical.
+//
+ReplayStats replayFlight(LanderSim &sim, const FlightRecorder &rec) {
+    typedef chrono::steady_clock Timer;
+    ReplayStats stats;
+    stats.frames = rec.frames;
+    stats.totalMillis = 0;
+    stats.maxFrameMillis = 0;
+    stats.trajectoryHash = 14695981039346656037ULL;
+
+    sim.recorder = NULL;
+    sim.setFixedStep(true, rec.rate);
+    sim.setState(rec.initial);
+
+    int next = 0;
+    for (int f = 0; f < rec.frames; f++) {
+        Timer::time_point start = Timer::now();
+        while (next < rec.events.size() && rec.events[next].frame <= f) {
+            const InputEvent &e = rec.events[next++];
+            if (e.pressed) sim.press(e.control);
+            else sim.release(e.control);
+        }
+        sim.update();
+        chrono::duration<double, milli> d = Timer::now() - start;
+        stats.totalMillis += d.count();
+        if (d.count() > stats.maxFrameMillis) stats.maxFrameMillis = d.count();
+        const Vec3 &p = sim.lander().position;
+        stats.trajectoryHash = hashBytes(stats.trajectoryHash, &p, sizeof(p));
+    }
+    stats.finalPosition = sim.lander().position;
+    return stats;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "LanderSim.h"
+
+//  One pilot input, stamped with the simulation frame it was applied on.
+//
+class InputEvent {
+public:
+    int frame;
+    LanderControl control;
+    bool pressed;
+};
+
+//  Records the inputs of a flight together with the state it started from.
+//
+//  While recording, the sim runs on a fixed time step so the same inputs
+//  fed back by replayFlight() reproduce the flight exactly.  Recordings are
+//  saved as small text files.
+//
+class FlightRecorder {
+public:
+    FlightRecorder() : frames(0), rate(60), recording(false) {}
+    void start(LanderSim &sim);
+    void stop(LanderSim &sim);
+    void record(int frame, LanderControl c, bool pressed);
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    LanderState initial;
+    std::vector<InputEvent> events;
+    int frames;         // length of the recording
+    float rate;         // fixed step rate, frames per second
+    bool recording;
+};
+
+//  Timing and outcome of one replay.
+//
+class ReplayStats {
+public:
+    int frames;
+    double totalMillis;
+    double maxFrameMillis;
+    Vec3 finalPosition;
+    uint64_t trajectoryHash;    // FNV-1a of the lander position every frame
+    double meanFrameMillis() const { return frames ? totalMillis / frames : 0; }
+};
+
+ReplayStats replayFlight(LanderSim &sim, const FlightRecorder &recording);
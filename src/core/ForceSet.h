@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Particle.h"
+#include "Random.h"
+
+//  Force pipeline fixed at compile time.
+//
+//  ParticleSystem::forces is a list of ParticleForce pointers, so every
+//  force on every particle is a virtual call the compiler can't see
+//  through.  A ForceSet<F...> instead holds its forces by value and walks
+//  the particle array once, calling each force's updateForce() by its
+//  exact type.  Those calls are static, so the force bodies inline into a
+//  single loop.  The system only pays one virtual call per update.
+//
+//      ForceSet<TurbulenceForce, CyclicForce> exhaust(
+//          TurbulenceForce(Vec3(-2, -1, -3), Vec3(1, 2, 5)), CyclicForce(20));
+//      sys->setForces(&exhaust);
+//      exhaust.get<1>().set(10);
+//
+//  The runtime list still works alongside a set, for forces that come and
+//  go while the game runs.
+//
+
+//  What ParticleSystem sees of a ForceSet.
+//
+class ParticleForceSet {
+public:
+    virtual ~ParticleForceSet() {}
+
+    // add every force to particles p[0..n-1], skipping those with skip[i]
+    // set (skip may be NULL), then retire one shot forces
+    //
+    virtual void apply(Particle *p, int n, const char *skip) = 0;
+    virtual void seed(const SquaresRandom &base, int firstStream) = 0;
+};
+
+// recursive storage, one force per level
+//
+template <class... F> class ForceChain;
+
+template <> class ForceChain<> {
+public:
+    void applyTo(Particle &) {}
+    void begin() {}
+    void end() {}
+    void seed(const SquaresRandom &, int) {}
+};
+
+template <class F, class... Rest> class ForceChain<F, Rest...> {
+public:
+    ForceChain() {}
+    ForceChain(const F &f, const Rest &... rest) : head(f), tail(rest...) {}
+
+    // the qualified call is not dispatched virtually
+    //
+    void applyTo(Particle &p) {
+        if (active) head.F::updateForce(&p);
+        tail.applyTo(p);
+    }
+    void begin() {
+        active = !head.applied;
+        tail.begin();
+    }
+    void end() {
+        if (head.applyOnce) head.applied = true;
+        tail.end();
+    }
+    void seed(const SquaresRandom &base, int stream) {
+        head.random = base.stream(stream);
+        tail.seed(base, stream + 1);
+    }
+
+    F head;
+    ForceChain<Rest...> tail;
+    bool active = true;
+};
+
+// type and reference of the force at index I
+//
+template <int I, class Chain> struct ForceAt;
+
+template <class F, class... Rest> struct ForceAt<0, ForceChain<F, Rest...> > {
+    typedef F type;
+    static F &get(ForceChain<F, Rest...> &c) { return c.head; }
+};
+
+template <int I, class F, class... Rest> struct ForceAt<I, ForceChain<F, Rest...> > {
+    typedef ForceAt<I - 1, ForceChain<Rest...> > Next;
+    typedef typename Next::type type;
+    static type &get(ForceChain<F, Rest...> &c) { return Next::get(c.tail); }
+};
+
+template <class... F>
+class ForceSet : public ParticleForceSet {
+public:
+    ForceSet() {}
+    ForceSet(const F &... f) : forces(f...) {}
+
+    void apply(Particle *p, int n, const char *skip) {
+        forces.begin();
+        if (skip) {
+            for (int i = 0; i < n; i++)
+                if (!skip[i]) forces.applyTo(p[i]);
+        }
+        else {
+            for (int i = 0; i < n; i++)
+                forces.applyTo(p[i]);
+        }
+        forces.end();
+    }
+
+    void seed(const SquaresRandom &base, int firstStream) {
+        forces.seed(base, firstStream);
+    }
+
+    template <int I>
+    typename ForceAt<I, ForceChain<F...> >::type &get() {
+        return ForceAt<I, ForceChain<F...> >::get(forces);
+    }
+
+    ForceChain<F...> forces;
+};
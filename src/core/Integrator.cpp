@@ -0,0 +1,133 @@
+
+#include "Integrator.h"
+#include <math.h>
+
+const float Integrator::DampingRate = 60;
+
+Integrator::Integrator(IntegratorType t) {
+    type = t;
+    adaptive = false;
+    tolerance = .001;
+    maxSubsteps = 8;
+}
+
+// n steps of size h from (x, v) under constant acceleration a and drag k
+//
+void Integrator::advance(Vec3 &x, Vec3 &v, const Vec3 &a, float k, float h, int n) const {
+    for (int i = 0; i < n; i++) {
+        switch (type) {
+            case EulerIntegrator: {
+                Vec3 acc = a - v * k;
+                x += v * h;
+                v += acc * h;
+                break;
+            }
+            case SemiImplicitEulerIntegrator: {
+                v += (a - v * k) * h;
+                x += v * h;
+                break;
+            }
+            case VerletIntegrator: {
+                // half kick, drift, half kick (drag solved implicitly)
+                //
+                Vec3 vh = v + (a - v * k) * (h * .5f);
+                x += vh * h;
+                v = (vh + a * (h * .5f)) / (1 + k * h * .5f);
+                break;
+            }
+            case RK4Integrator: {
+                Vec3 k1x = v,                        k1v = a - v * k;
+                Vec3 v2 = v + k1v * (h * .5f);
+                Vec3 k2x = v2,                       k2v = a - v2 * k;
+                Vec3 v3 = v + k2v * (h * .5f);
+                Vec3 k3x = v3,                       k3v = a - v3 * k;
+                Vec3 v4 = v + k3v * h;
+                Vec3 k4x = v4,                       k4v = a - v4 * k;
+                x += (k1x + (k2x + k3x) * 2 + k4x) * (h / 6);
+                v += (k1v + (k2v + k3v) * 2 + k4v) * (h / 6);
+                break;
+            }
+        }
+    }
+}
+
+// factor p's damping scales its velocity by over frames steps of dt,
+// leaving forces aside: once per step for Euler, as drag otherwise
+//
+float Integrator::decay(const Particle &p, float dt, int frames) const {
+    if (type == EulerIntegrator) return powf(p.damping, frames);
+    float k = p.damping > 0 ? -logf(p.damping) * DampingRate : 0;
+    return expf(-k * dt * frames);
+}
+
+// the frame in n substeps: Euler through Particle::integrate(), so it
+// keeps the fixed step's damping, the others through advance()
+//
+void Integrator::substeps(const Particle &p, Vec3 &x, Vec3 &v, const Vec3 &a, float k, float dt, int n) const {
+    if (type != EulerIntegrator) {
+        x = p.position;
+        v = p.velocity;
+        advance(x, v, a, k, dt / n, n);
+        return;
+    }
+    Particle q = p;
+    q.damping = n > 1 ? powf(p.damping, 1.0f / n) : p.damping;
+    for (int i = 0; i < n; i++) {
+        q.forces = p.forces;
+        q.integrate(dt / n);
+    }
+    x = q.position;
+    v = q.velocity;
+}
+
+int Integrator::step(Particle &p, float dt) const {
+    if (!adaptive) {
+        if (type == EulerIntegrator) p.integrate(dt);
+        else {
+            Vec3 a = p.acceleration + p.forces * (1.0 / p.mass);
+            float k = p.damping > 0 ? -logf(p.damping) * DampingRate : 0;
+            advance(p.position, p.velocity, a, k, dt, 1);
+            p.forces.set(0, 0, 0);
+        }
+        return 1;
+    }
+
+    Vec3 a = p.acceleration + p.forces * (1.0 / p.mass);
+    float rate = type == EulerIntegrator ? 1 / dt : DampingRate;
+    float k = p.damping > 0 ? -logf(p.damping) * rate : 0;
+
+    // leading term of the position error over the frame in n substeps,
+    // for constant a and drag k, with c = |a - k v| dt^2:
+    //   Euler, semi-implicit Euler   c / 2n
+    //   Verlet                       c k dt / 6n^2
+    //   RK4                          about c (k dt)^3 / 120n^4
+    // n doubles until it is within tolerance (compared squared)
+    //
+    float c2 = (a - p.velocity * k).lengthSquared() * (dt * dt) * (dt * dt);
+    float kdt2 = (k * dt) * (k * dt);
+    float e2;
+    int order;
+    switch (type) {
+        case VerletIntegrator: e2 = c2 * kdt2 / 36; order = 2; break;
+        case RK4Integrator: e2 = c2 * kdt2 * kdt2 * kdt2 / 14400; order = 4; break;
+        default: e2 = c2 / 4; order = 1; break;
+    }
+    float shrink = 1.0f / (1 << (2 * order));
+    float tol2 = tolerance * tolerance;
+    int n = 1;
+    while (e2 > tol2 && n < maxSubsteps) {
+        n *= 2;
+        e2 *= shrink;
+    }
+    if (type == EulerIntegrator && n == 1) {
+        p.integrate(dt);
+        return 1;
+    }
+
+    Vec3 x, v;
+    substeps(p, x, v, a, k, dt, n);
+    p.position = x;
+    p.velocity = v;
+    p.forces.set(0, 0, 0);
+    return n;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Vec3.h"
+#include "Particle.h"
+
+typedef enum { EulerIntegrator, SemiImplicitEulerIntegrator, VerletIntegrator, RK4Integrator } IntegratorType;
+
+//  Advances particles over one frame, chosen per ParticleSystem.
+//
+//  EulerIntegrator is Particle::integrate(): position from the old
+//  velocity and damping applied once per call, so results depend on the
+//  frame rate.  The other methods treat damping as a continuous drag that
+//  matches it at DampingRate frames per second:
+//
+//      dv/dt = a - k v,   k = -ln(damping) * DampingRate
+//
+//  Forces are sampled once per frame (forces can be random or one shot),
+//  so each step integrates against a fixed acceleration plus the drag.
+//
+//  With adaptive on, the number of substeps is picked per particle from
+//  the leading term of each method's position error for the frame's
+//  acceleration and drag: n doubles, up to maxSubsteps, until that
+//  estimate is within tolerance, and the frame is stepped once with n
+//  substeps.  A frame that needs no refining then costs one step plus
+//  a few multiplies, and a long frame costs extra substeps only on the
+//  particles that need them.  Euler substeps are Particle::integrate()
+//  with the damping spread over them, whose limit is the drag
+//  -ln(damping) / dt.
+//
+class Integrator {
+public:
+    Integrator(IntegratorType type = EulerIntegrator);
+    int step(Particle &p, float dt) const;      // one frame, clears p.forces,
+                                                // returns substeps taken
+    float decay(const Particle &p, float dt, int frames) const;
+
+    static const float DampingRate;
+
+    IntegratorType type;
+    bool adaptive;
+    float tolerance;    // max position error per frame, world units
+    int maxSubsteps;
+
+private:
+    void advance(Vec3 &x, Vec3 &v, const Vec3 &a, float k, float h, int n) const;
+    void substeps(const Particle &p, Vec3 &x, Vec3 &v, const Vec3 &a, float k, float dt, int n) const;
+};
@@ -0,0 +1,254 @@
+
+#include "LanderSim.h"
+#include "FlightRecorder.h"
+#include "Profiler.h"
+#include <iostream>
+
+using namespace std;
+
+const float LanderSim::FullFuel = 120000;     // 120000ms = 120s
+
+// thrust added and exhaust direction for each thruster key
+//
+static const Vec3 thrustForControl[] = {
+    Vec3(0, .5, 0), Vec3(0, -.5, 0), Vec3(-.5, 0, 0), Vec3(.5, 0, 0), Vec3(0, 0, 0.5), Vec3(0, 0, -0.5)
+};
+static const Vec3 exhaustForControl[] = {
+    Vec3(0, -5, 0), Vec3(0, -5, 0), Vec3(5, -5, 0), Vec3(-5, -5, 0), Vec3(0, -5, -5), Vec3(0, -5, 5)
+};
+
+LanderSim::LanderSim() :
+    exhaustForces(TurbulenceForce(Vec3(-2, -1, -3), Vec3(1, 2, 5)), ImpulseRadialForce(10), CyclicForce(20))
+{
+    octree = NULL;
+    telemetry = NULL;
+    recorder = NULL;
+    bFixedStep = false;
+    frame = 0;
+    seed = SquaresRandom::DefaultSeed;
+
+    //engine emitter, pool sized for the full exhaust plume up front
+    engine.sys->setCapacity(4096);
+    engine.setRate(600);
+    engine.setParticleRadius(.010);
+    engine.setEmitterType(DiscEmitter);
+    engine.setLifespan(0.5);
+    engine.visible = false;
+
+    //rocket lander particles
+    Particle rocket;
+    rocket.radius = 0.00010;
+    rocket.lifespan = 50;
+    rocket.position.set(0, 10, 0);
+    sys.add(rocket);
+    sys.addForce(&thrust);
+    sys.addForce(&impulseForce);
+
+    //engine forces, composed statically since they run on every exhaust particle
+    engine.sys->setForces(&exhaustForces);
+    engine.setGroupSize(10);
+
+    //exhaust thins out when frames run over budget
+    engine.sys->budget = &budget;
+    engine.sys->lodDistance = 8;
+
+    //lander steps with velocity verlet, refining long frames; the
+    //exhaust only needs the cheap stable semi-implicit euler
+    sys.integrator.type = VerletIntegrator;
+    sys.integrator.adaptive = true;
+    sys.integrator.tolerance = .0005;
+    engine.sys->integrator.type = SemiImplicitEulerIntegrator;
+
+    //rocket's gravity force
+    gravity.set(Vec3(0, -.01, 0));
+    sys.addForce(&gravity);
+
+    fuel = FullFuel;
+    thrustTime = 0;
+    altitudes = 0;
+    collided = false;
+    gameOver = false;
+    restitution = .3;
+    friction = .5;
+    contactSkin = .1;
+}
+
+void LanderSim::setTerrain(Octree *o, TerrainCollider *collider) {
+    octree = o;
+    terrainCursor.reset();
+    engine.sys->terrain = collider;
+}
+
+// run on a deterministic clock that advances 1/rate sec per update (used
+// for recording and replay), or on the default clock when b is false
+//
+void LanderSim::setFixedStep(bool b, float rate) {
+    bFixedStep = b;
+    fixedClock.rate = rate;
+    sys.clock = bFixedStep ? &fixedClock : NULL;
+    engine.sys->clock = bFixedStep ? &fixedClock : NULL;
+}
+
+void LanderSim::press(LanderControl c) {
+    if (recorder) recorder->record(frame, c, true);
+    if (c == Restart) {
+        if (gameOver) {
+            gameOver = false;
+            fuel = FullFuel;
+        }
+        return;
+    }
+    if (c == OtherKey) return;
+    if (gameOver) {
+        engine.stop();
+        return;
+    }
+    thrustTime = getClock()->elapsedMillis();
+    thrust.add(thrustForControl[c]);
+    engine.setVelocity(exhaustForControl[c]);
+    engine.start();
+}
+
+void LanderSim::release(LanderControl c) {
+    if (recorder) recorder->record(frame, c, false);
+    getClock()->reset();
+    if (c == Restart || c == OtherKey) return;
+    engine.stop();
+    thrust.set(Vec3(0, 0, 0));
+    fuel -= thrustTime;
+}
+
+// one simulation frame
+//
+void LanderSim::update() {
+    PROFILE_SCOPE("LanderSim::update");
+    sys.update();
+    engine.update();
+    engine.setPosition(sys.particles[0].position);
+    detectCollision();
+
+    // terrain relative altitude from the altimeter, or the height above
+    // the mesh origin while there is no terrain
+    //
+    altitudes = sys.particles[0].position.y + 6;
+    if (octree && altimeter.measure(*octree, lander().position + Vec3(6, 6, 6), lander().velocity))
+        altitudes = altimeter.agl;
+
+    // running out of fuel ends the game
+    //
+    if (fuel > 0) gameOver = false;
+    else {
+        gameOver = true;
+        fuel = 0;
+        engine.stop();
+    }
+
+    logTelemetry();
+    if (bFixedStep) fixedClock.advance();
+    frame++;
+}
+
+// hand this frame's flight data to the telemetry ring; never waits, and
+// compiles to nothing with LANDER_TELEMETRY 0
+//
+void LanderSim::logTelemetry() {
+#if LANDER_TELEMETRY >= TELEMETRY_FLIGHT
+    if (telemetry == NULL) return;
+    const Particle &p = sys.particles[0];
+    TelemetryRecord r = TelemetryRecord();
+    r.frame = frame;
+    r.millis = getClock()->elapsedMillis();
+    r.position = p.position;
+    r.velocity = p.velocity;
+    r.altitude = altitudes;
+    r.timeToImpact = altimeter.timeToImpact;
+    r.fuel = fuel;
+    r.collided = collided;
+    r.gameOver = gameOver;
+    r.thrusting = engine.started;
+#if LANDER_TELEMETRY >= TELEMETRY_DEBUG
+    r.touchPoint = touchPoint;
+    r.contactNormal = contact.normal;
+    r.contactDepth = contact.hit ? contact.depth : 0;
+    r.triangle = contact.hit ? contact.triangle : -1;
+#else
+    r.triangle = -1;
+#endif
+    telemetry->push(r);
+#endif
+}
+
+// collision detection.  one contact query per frame; when the lander is at
+// or below the surface it is pushed back out along the face normal and an
+// impulse removes the velocity into the surface (keeping "restitution" of
+// it as a bounce) and damps the sliding part.
+//
+void LanderSim::detectCollision() {
+    PROFILE_SCOPE("LanderSim::detectCollision");
+    if (octree == NULL) return;
+    Particle &lander = sys.particles[0];
+    touchPoint = lander.position + Vec3(6, 6, 6);
+    octree->contact(touchPoint, contact, terrainCursor);
+    collided = contact.hit && contact.depth > -contactSkin;
+    if (!contact.hit || contact.depth < 0) return;
+
+    lander.position += contact.normal * contact.depth;
+    float vn = lander.velocity.dot(contact.normal);
+    if (vn < 0) {
+        Vec3 tangent = lander.velocity - contact.normal * vn;
+        Vec3 dv = contact.normal * (-(1 + restitution) * vn) - tangent * friction;
+
+        // as a force over the next step: f = m * dv / dt
+        //
+        float rate = getClock()->frameRate();
+        if (rate < 1) rate = 60;
+        impulseForce.apply(dv * (lander.mass * rate));
+    }
+}
+
+LanderState LanderSim::getState() {
+    LanderState s;
+    s.position = sys.particles[0].position;
+    s.velocity = sys.particles[0].velocity;
+    s.thrust = thrust.get();
+    s.impulse = impulseForce.force;
+    s.impulseApplied = impulseForce.applied;
+    s.fuel = fuel;
+    s.thrustTime = thrustTime;
+    s.clockMillis = getClock()->elapsedMillis();
+    s.collided = collided;
+    s.gameOver = gameOver;
+    s.engineVelocity = engine.velocity;
+    s.engineStarted = engine.started;
+    s.seed = seed;
+    return s;
+}
+
+// restore a snapshot.  exhaust particles are dropped and all random streams
+// are reseeded, so two runs from the same state evolve identically.
+//
+void LanderSim::setState(const LanderState &s) {
+    if (bFixedStep) fixedClock.millis = s.clockMillis;
+    terrainCursor.reset();
+    Particle &p = sys.particles[0];
+    p.position = s.position;
+    p.velocity = s.velocity;
+    p.forces.set(0, 0, 0);
+    p.birthtime = s.clockMillis;
+    thrust.set(s.thrust);
+    impulseForce.force = s.impulse;
+    impulseForce.applied = s.impulseApplied;
+    fuel = s.fuel;
+    thrustTime = s.thrustTime;
+    collided = s.collided;
+    gameOver = s.gameOver;
+    engine.sys->particles.clear();
+    engine.velocity = s.engineVelocity;
+    engine.started = s.engineStarted;
+    engine.fired = false;
+    engine.lastSpawned = s.clockMillis;
+    seed = s.seed;
+    sys.setSeed(seed);
+    engine.sys->setSeed(seed + 1);
+    frame = 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include "Vec3.h"
+#include "Clock.h"
+#include "Octree.h"
+#include "Particle.h"
+#include "ParticleSystem.h"
+#include "ParticleEmitter.h"
+#include "TerrainCollider.h"
+#include "Telemetry.h"
+#include "Altimeter.h"
+
+class FlightRecorder;
+
+//  Pilot inputs.  One per thruster key, plus restart and "any other key"
+//  (every key release restarts the fuel timer, so those matter too).
+//
+typedef enum { ThrustUp, ThrustDown, ThrustLeft, ThrustRight, ThrustForward, ThrustBack,
+    Restart, OtherKey, NumLanderControls } LanderControl;
+
+//  Everything the lander's flight depends on, for snapshots and replay.
+//
+class LanderState {
+public:
+    Vec3 position;
+    Vec3 velocity;
+    Vec3 thrust;
+    Vec3 impulse;
+    bool impulseApplied;
+    float fuel;
+    float thrustTime;
+    float clockMillis;
+    bool collided;
+    bool gameOver;
+    Vec3 engineVelocity;
+    bool engineStarted;
+    uint64_t seed;
+};
+
+//  The lander flight without any rendering: rocket particle and its
+//  forces, exhaust emitter, fuel and terrain collision.  ofApp feeds it key
+//  presses and draws the result; headless tools drive it directly.
+//
+class LanderSim {
+public:
+    LanderSim();
+    void setTerrain(Octree *octree, TerrainCollider *collider);
+    void setFixedStep(bool b, float rate = 60);
+    bool isFixedStep() const { return bFixedStep; }
+    void press(LanderControl);
+    void release(LanderControl);
+    void update();
+    void detectCollision();
+    void logTelemetry();
+    LanderState getState();
+    void setState(const LanderState &);
+    Clock *getClock() { return bFixedStep ? &fixedClock : Clock::getDefault(); }
+    const Particle &lander() const { return sys.particles[0]; }
+
+    static const float FullFuel;    // ms of thrust in a full tank
+
+    ParticleSystem sys;
+    ThrusterForce thrust;
+    ImpulseForce impulseForce;
+    GravityForce gravity;
+    ParticleEmitter engine;
+    ForceSet<TurbulenceForce, ImpulseRadialForce, CyclicForce> exhaustForces;
+    ParticleBudget budget;          // exhaust fidelity, fed frame times by the app
+
+    Octree *octree;
+    FlightRecorder *recorder;       // if set, every input is logged to it
+    TelemetryRing *telemetry;       // if set, gets a record every update
+    float fuel;
+    float thrustTime;
+    float altitudes;                // above the terrain once it is loaded
+    Altimeter altimeter;
+    bool collided;
+    bool gameOver;
+    Vec3 touchPoint;
+    Contact contact;                // terrain contact from the last update
+    OctreeCursor terrainCursor;     // lander's place in the octree between updates
+    float restitution;              // bounce kept off the terrain
+    float friction;                 // fraction of sliding velocity lost
+    float contactSkin;              // counts as landed this close above ground
+    int frame;                      // updates since the last setState()
+    uint64_t seed;
+
+private:
+    FixedClock fixedClock;
+    bool bFixedStep;
+};
@@ -0,0 +1,110 @@
+#include "Lidar.h"
+#include "Profiler.h"
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+void LidarPattern::clear() {
+    directions.clear();
+    order.clear();
+}
+
+void LidarPattern::add(float azimuth, float elevation) {
+    directions.push_back(Vec3(cosf(elevation) * sinf(azimuth), sinf(elevation),
+                              cosf(elevation) * cosf(azimuth)));
+}
+
+// columns x rows rays evenly over a fovX by fovY (radians) window
+//
+void LidarPattern::grid(float fovX, float fovY, int columns, int rows) {
+    clear();
+    for (int j = 0; j < rows; j++) {
+        float elevation = rows > 1 ? fovY * (j / (rows - 1.0f) - .5f) : 0;
+        for (int i = 0; i < columns; i++) {
+            float azimuth = columns > 1 ? fovX * (i / (columns - 1.0f) - .5f) : 0;
+            add(azimuth, elevation);
+        }
+    }
+    prepare();
+}
+
+// spread the low 16 bits of x to the even bits
+//
+static uint32_t spreadBits(uint32_t x) {
+    x &= 0xffff;
+    x = (x | (x << 8)) & 0x00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+void LidarPattern::prepare() {
+    int n = directions.size();
+    vector<pair<uint32_t, int> > keys(n);
+    for (int i = 0; i < n; i++) {
+        const Vec3 &d = directions[i];
+        float azimuth = atan2f(d.x, d.z) / (float)M_PI * .5f + .5f;           // 0 to 1
+        float elevation = asinf(max(-1.0f, min(1.0f, d.y))) / (float)M_PI + .5f;
+        uint32_t a = (uint32_t)(azimuth * 65535), e = (uint32_t)(elevation * 65535);
+        keys[i] = make_pair(spreadBits(a) | (spreadBits(e) << 1), i);
+    }
+    sort(keys.begin(), keys.end());
+    order.resize(n);
+    for (int i = 0; i < n; i++) order[i] = keys[i].second;
+}
+
+Lidar::Lidar() {
+    range = 1000;
+    grain = 256;
+    pool = &ThreadPool::shared();
+    setPose(Vec3(0, 0, 0), Vec3(0, -1, 0), Vec3(0, 0, 1));
+}
+
+// forward is where the pattern's 0 0 ray points; up need only be roughly
+// perpendicular to it
+//
+void Lidar::setPose(const Vec3 &o, const Vec3 &f, const Vec3 &u) {
+    origin = o;
+    forward = f.getNormalized();
+    right = u.cross(forward).getNormalized();
+    up = forward.cross(right);
+}
+
+void Lidar::scan(const Octree &terrain, const LidarPattern &pattern, LidarScan &rtn) const {
+    PROFILE_SCOPE("Lidar::scan");
+    typedef std::chrono::steady_clock Timer;
+    Timer::time_point start = Timer::now();
+    int n = pattern.size();
+    bool ordered = pattern.order.size() == n;
+    rtn.distances.resize(n);
+    rtn.points.resize(n);
+
+    auto cast = [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            int i = ordered ? pattern.order[k] : k;
+            const Vec3 &d = pattern.directions[i];
+            Vec3 dir = right * d.x + up * d.y + forward * d.z;
+            RayHit hit;
+            if (terrain.raycast(origin, dir, range, hit)) {
+                rtn.distances[i] = hit.distance;
+                rtn.points[i] = hit.point;
+            }
+            else {
+                rtn.distances[i] = -1;
+                rtn.points[i] = origin;
+            }
+        }
+    };
+    if (pool) pool->parallelFor(n, cast, grain);
+    else cast(0, n);
+
+    rtn.returns = 0;
+    for (int i = 0; i < n; i++)
+        if (rtn.distances[i] >= 0) rtn.returns++;
+    rtn.threads = pool ? pool->size() : 1;
+    rtn.millis = std::chrono::duration<double, std::milli>(Timer::now() - start).count();
+}
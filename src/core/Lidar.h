@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+#include "Octree.h"
+#include "ThreadPool.h"
+
+//  Scan pattern of a lidar as unit ray directions in the sensor's frame
+//  (x right, y up, z forward).  prepare() fixes the order the rays are
+//  cast in: Morton order over azimuth and elevation, so rays that point
+//  the same way (and so walk much the same nodes and faces) run back to
+//  back on the same thread.
+//
+class LidarPattern {
+public:
+    void clear();
+    void add(float azimuth, float elevation);      // radians, 0 0 is straight ahead
+    void grid(float fovX, float fovY, int columns, int rows);
+    void prepare();
+    int size() const { return directions.size(); }
+
+    std::vector<Vec3> directions;
+    std::vector<int> order;         // rays in casting order, set by prepare()
+};
+
+//  Result of one sweep, indexed like the pattern's rays.
+//
+class LidarScan {
+public:
+    LidarScan() : returns(0), millis(0), threads(1) {}
+    double raysPerSecond() const { return millis > 0 ? distances.size() * 1000 / millis : 0; }
+
+    std::vector<float> distances;   // -1 for no return within range
+    std::vector<Vec3> points;       // hit points in terrain mesh space
+    int returns;
+    double millis;                  // time the sweep took
+    int threads;                    // that shared the sweep
+};
+
+//  Lidar sensor casting a pattern against the terrain octree.  scan()
+//  splits the pattern's ordered rays into runs of "grain" across the
+//  thread pool (or casts them all on the calling thread if pool is NULL);
+//  each ray is one Octree::raycast().  The octree is only read, so a scan
+//  may run while the sim is stepping.
+//
+class Lidar {
+public:
+    Lidar();
+    void setPose(const Vec3 &origin, const Vec3 &forward, const Vec3 &up);
+    void scan(const Octree &terrain, const LidarPattern &pattern, LidarScan &rtn) const;
+
+    Vec3 origin;
+    Vec3 right, up, forward;        // sensor frame in mesh space
+    float range;
+    int grain;
+    ThreadPool *pool;
+};
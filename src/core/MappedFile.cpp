@@ -0,0 +1,62 @@
+#include "MappedFile.h"
+#include <stdio.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile() : bytes(NULL), length(0), mapped(false) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string &path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);        // the mapping keeps the file open
+    if (p == MAP_FAILED) return false;
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    bytes = (const unsigned char *)p;
+    length = st.st_size;
+    mapped = true;
+    return true;
+#else
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > 0) {
+        buffer.resize(size);
+        if (fread(&buffer[0], 1, size, fp) != (size_t)size) buffer.clear();
+    }
+    fclose(fp);
+    if (buffer.empty()) return false;
+    bytes = &buffer[0];
+    length = buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped) munmap((void *)bytes, length);
+#endif
+    vector<unsigned char>().swap(buffer);
+    bytes = NULL;
+    length = 0;
+    mapped = false;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+//  Read only view of a whole file.  On POSIX systems the file is memory
+//  mapped, so its pages are read in by the OS as they are touched and
+//  nothing is copied up front; elsewhere it falls back to reading the file
+//  into memory.  The view stays valid until close() or destruction.
+//
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return bytes != NULL; }
+    const unsigned char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    MappedFile(const MappedFile &);                 // not copyable
+    MappedFile &operator=(const MappedFile &);
+    const unsigned char *bytes;
+    size_t length;
+    bool mapped;
+    std::vector<unsigned char> buffer;      // when not mapped
+};
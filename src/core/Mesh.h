@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+
+//  Indexed triangle mesh for the simulation core (positions, optional
+//  normals, three indices per face).  The app layer fills one from an
+//  ofMesh; the Octree and terrain code only ever read it.
+//
+class Mesh {
+public:
+    std::vector<Vec3> vertices;
+    std::vector<Vec3> normals;
+    std::vector<unsigned int> indices;
+
+    int getNumVertices() const { return vertices.size(); }
+    const Vec3 &getVertex(int i) const { return vertices[i]; }
+    int getNumFaces() const { return indices.size() / 3; }
+    const Vec3 &getFaceVertex(int face, int corner) const {
+        return vertices[indices[face * 3 + corner]];
+    }
+};
@@ -0,0 +1,363 @@
+#include "MeshSimplifier.h"
+#include "Triangle.h"
+#include "Profiler.h"
+#include <float.h>
+#include <math.h>
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+using namespace std;
+
+// symmetric 4x4 quadric, upper triangle row by row
+//
+class Quadric {
+public:
+    Quadric() { for (int i = 0; i < 10; i++) q[i] = 0; }
+
+    // squared distance to the plane n.p + d = 0 (n unit length), scaled
+    //
+    Quadric(const Vec3 &n, float d, double weight) {
+        double a = n.x, b = n.y, c = n.z, e = d;
+        q[0] = a * a; q[1] = a * b; q[2] = a * c; q[3] = a * e;
+        q[4] = b * b; q[5] = b * c; q[6] = b * e;
+        q[7] = c * c; q[8] = c * e;
+        q[9] = e * e;
+        for (int i = 0; i < 10; i++) q[i] *= weight;
+    }
+    Quadric &operator+=(const Quadric &o) {
+        for (int i = 0; i < 10; i++) q[i] += o.q[i];
+        return *this;
+    }
+    Quadric operator+(const Quadric &o) const {
+        Quadric r = *this;
+        return r += o;
+    }
+    double error(const Vec3 &v) const {
+        double x = v.x, y = v.y, z = v.z;
+        return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x +
+            q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y +
+            q[7] * z * z + 2 * q[8] * z + q[9];
+    }
+
+    // point of least error, false if the quadric is (near) singular, as on
+    // flat or straight regions where any point along them is as good
+    //
+    bool minimum(Vec3 &v) const {
+        double det = q[0] * (q[4] * q[7] - q[5] * q[5]) - q[1] * (q[1] * q[7] - q[5] * q[2]) +
+            q[2] * (q[1] * q[5] - q[4] * q[2]);
+        double scale = q[0] + q[4] + q[7];
+        if (fabs(det) <= 1e-9 * scale * scale * scale || scale == 0) return false;
+        double inv = 1 / det;
+        double bx = -q[3], by = -q[6], bz = -q[8];
+        v.x = inv * (bx * (q[4] * q[7] - q[5] * q[5]) - q[1] * (by * q[7] - q[5] * bz) + q[2] * (by * q[5] - q[4] * bz));
+        v.y = inv * (q[0] * (by * q[7] - bz * q[5]) - bx * (q[1] * q[7] - q[5] * q[2]) + q[2] * (q[1] * bz - by * q[2]));
+        v.z = inv * (q[0] * (q[4] * bz - q[5] * by) - q[1] * (q[1] * bz - by * q[2]) + bx * (q[1] * q[5] - q[4] * q[2]));
+        return true;
+    }
+
+    double q[10];
+};
+
+class Collapse {
+public:
+    double cost;
+    int u, v;
+    int versionU, versionV;
+    Vec3 target;
+    bool operator<(const Collapse &o) const { return cost > o.cost; }    // min heap
+};
+
+// working state of one simplification
+//
+class Simplifier {
+public:
+    Simplifier(const Mesh &in);
+    void run(float maxError, float maxEdge, int targetFaces);
+    void output(Mesh &out) const;
+
+    int liveFaces;
+
+private:
+    Vec3 faceNormal(int f) const;
+    void push(int u, int v);
+    bool flips(int from, int other, const Vec3 &target) const;
+    bool stretches(int from, const Vec3 &target, float maxEdge) const;
+    void neighbors(int v, vector<int> &rtn) const;
+    void collapse(const Collapse &c);
+
+    vector<Vec3> pos;
+    vector<Quadric> quadrics;
+    vector<int> faces;                  // 3 per face, -1 once removed
+    vector<vector<int> > vertexFaces;
+    vector<int> version;
+    vector<bool> removed;
+    priority_queue<Collapse> heap;
+};
+
+// border edges are pinned with a heavily weighted plane through the edge,
+// perpendicular to its face
+//
+static const double BorderWeight = 1000;
+
+Simplifier::Simplifier(const Mesh &in) {
+    pos = in.vertices;
+    int nv = pos.size();
+    quadrics.resize(nv);
+    version.assign(nv, 0);
+    removed.assign(nv, false);
+    vertexFaces.resize(nv);
+    faces.assign(in.indices.begin(), in.indices.end());
+    liveFaces = in.getNumFaces();
+
+    vector<pair<int, int> > edges;
+    for (int f = 0; f < liveFaces; f++) {
+        Vec3 n = faceNormal(f);
+        float d = -n.dot(pos[faces[f * 3]]);
+        Quadric k(n, d, 1);
+        for (int i = 0; i < 3; i++) {
+            int a = faces[f * 3 + i], b = faces[f * 3 + (i + 1) % 3];
+            quadrics[a] += k;
+            vertexFaces[a].push_back(f);
+            edges.push_back(make_pair(min(a, b), max(a, b)));
+        }
+    }
+
+    // an edge seen once is on the border
+    //
+    sort(edges.begin(), edges.end());
+    for (int i = 0; i < edges.size(); ) {
+        int j = i;
+        while (j < edges.size() && edges[j] == edges[i]) j++;
+        int a = edges[i].first, b = edges[i].second;
+        if (j - i == 1) {
+            for (int k = 0; k < vertexFaces[a].size(); k++) {
+                int f = vertexFaces[a][k];
+                if (faces[f * 3] != b && faces[f * 3 + 1] != b && faces[f * 3 + 2] != b) continue;
+                Vec3 side = (pos[b] - pos[a]).cross(faceNormal(f)).getNormalized();
+                Quadric border(side, -side.dot(pos[a]), BorderWeight);
+                quadrics[a] += border;
+                quadrics[b] += border;
+                break;
+            }
+        }
+        i = j;
+    }
+    for (int i = 0; i < edges.size(); i++) {
+        if (i > 0 && edges[i] == edges[i - 1]) continue;
+        push(edges[i].first, edges[i].second);
+    }
+}
+
+Vec3 Simplifier::faceNormal(int f) const {
+    const Vec3 &a = pos[faces[f * 3]];
+    return (pos[faces[f * 3 + 1]] - a).cross(pos[faces[f * 3 + 2]] - a).getNormalized();
+}
+
+// queue the collapse of edge uv at its best point: the quadric minimum if
+// there is one, otherwise the better of the ends and the middle
+//
+void Simplifier::push(int u, int v) {
+    Quadric q = quadrics[u] + quadrics[v];
+    Collapse c;
+    c.u = u;
+    c.v = v;
+    c.versionU = version[u];
+    c.versionV = version[v];
+    if (!q.minimum(c.target)) {
+        Vec3 candidates[3] = { pos[u], pos[v], (pos[u] + pos[v]) / 2 };
+        c.target = candidates[0];
+        for (int i = 1; i < 3; i++)
+            if (q.error(candidates[i]) < q.error(c.target)) c.target = candidates[i];
+    }
+    c.cost = max(0.0, q.error(c.target));
+    heap.push(c);
+}
+
+// would moving "from" to target turn any of its faces (other than those
+// shared with "other", which disappear) over or to nothing
+//
+bool Simplifier::flips(int from, int other, const Vec3 &target) const {
+    for (int k = 0; k < vertexFaces[from].size(); k++) {
+        int f = vertexFaces[from][k];
+        const int *t = &faces[f * 3];
+        if (t[0] == other || t[1] == other || t[2] == other) continue;
+        Vec3 p[3];
+        for (int i = 0; i < 3; i++) p[i] = t[i] == from ? target : pos[t[i]];
+        Vec3 n = (p[1] - p[0]).cross(p[2] - p[0]);
+        if (n.lengthSquared() < 1e-20) return true;
+        if (n.getNormalized().dot(faceNormal(f)) < .2f) return true;
+    }
+    return false;
+}
+
+bool Simplifier::stretches(int from, const Vec3 &target, float maxEdge) const {
+    float limit = maxEdge * maxEdge;
+    for (int k = 0; k < vertexFaces[from].size(); k++) {
+        const int *t = &faces[vertexFaces[from][k] * 3];
+        for (int i = 0; i < 3; i++)
+            if (t[i] != from && pos[t[i]].squareDistance(target) > limit) return true;
+    }
+    return false;
+}
+
+void Simplifier::neighbors(int v, vector<int> &rtn) const {
+    rtn.clear();
+    for (int k = 0; k < vertexFaces[v].size(); k++) {
+        int f = vertexFaces[v][k];
+        for (int i = 0; i < 3; i++)
+            if (faces[f * 3 + i] != v) rtn.push_back(faces[f * 3 + i]);
+    }
+    sort(rtn.begin(), rtn.end());
+    rtn.erase(unique(rtn.begin(), rtn.end()), rtn.end());
+}
+
+// merge v into u at the collapse target
+//
+void Simplifier::collapse(const Collapse &c) {
+    int u = c.u, v = c.v;
+    pos[u] = c.target;
+    quadrics[u] += quadrics[v];
+    for (int k = 0; k < vertexFaces[v].size(); k++) {
+        int f = vertexFaces[v][k];
+        int *t = &faces[f * 3];
+        if (t[0] == u || t[1] == u || t[2] == u) {
+            for (int i = 0; i < 3; i++) {
+                if (t[i] == v) continue;
+                vector<int> &list = vertexFaces[t[i]];
+                list.erase(remove(list.begin(), list.end(), f), list.end());
+            }
+            t[0] = t[1] = t[2] = -1;
+            liveFaces--;
+            continue;
+        }
+        for (int i = 0; i < 3; i++)
+            if (t[i] == v) t[i] = u;
+        vertexFaces[u].push_back(f);
+    }
+    vertexFaces[v].clear();
+    removed[v] = true;
+    version[u]++;
+    version[v]++;
+
+    vector<int> around;
+    neighbors(u, around);
+    for (int i = 0; i < around.size(); i++) push(u, around[i]);
+}
+
+void Simplifier::run(float maxError, float maxEdge, int targetFaces) {
+    double limit = (double)maxError * maxError;
+    vector<int> nu, nv, shared;
+    while (!heap.empty() && liveFaces > targetFaces) {
+        Collapse c = heap.top();
+        heap.pop();
+        if (removed[c.u] || removed[c.v] || c.versionU != version[c.u] || c.versionV != version[c.v])
+            continue;
+        if (c.cost > limit) break;
+
+        // keep the surface a manifold: an interior edge may share only the
+        // two vertices opposite it with its ends
+        //
+        neighbors(c.u, nu);
+        neighbors(c.v, nv);
+        shared.clear();
+        set_intersection(nu.begin(), nu.end(), nv.begin(), nv.end(), back_inserter(shared));
+        if (shared.size() > 2) continue;
+        if (flips(c.u, c.v, c.target) || flips(c.v, c.u, c.target)) continue;
+        if (maxEdge > 0 && (stretches(c.u, c.target, maxEdge) || stretches(c.v, c.target, maxEdge))) continue;
+        collapse(c);
+    }
+}
+
+void Simplifier::output(Mesh &out) const {
+    vector<int> remap(pos.size(), -1);
+    out.vertices.clear();
+    out.normals.clear();
+    out.indices.clear();
+    for (int f = 0; f < faces.size() / 3; f++) {
+        if (faces[f * 3] < 0) continue;
+        for (int i = 0; i < 3; i++) {
+            int v = faces[f * 3 + i];
+            if (remap[v] < 0) {
+                remap[v] = out.vertices.size();
+                out.vertices.push_back(pos[v]);
+            }
+            out.indices.push_back(remap[v]);
+        }
+    }
+}
+
+bool simplifyMesh(const Mesh &in, Mesh &out, float maxError, float maxEdge, int targetFaces,
+                  SimplifyStats *stats) {
+    PROFILE_SCOPE("simplifyMesh");
+    if (in.getNumFaces() == 0) return false;
+    Simplifier simplifier(in);
+    simplifier.run(maxError, maxEdge, targetFaces);
+    simplifier.output(out);
+    if (stats) {
+        stats->sourceFaces = in.getNumFaces();
+        stats->sourceVertices = in.getNumVertices();
+        stats->faces = out.getNumFaces();
+        stats->vertices = out.getNumVertices();
+        // the proxy's own vertices can sit off the source surface even when
+        // every source vertex is close to the proxy, so measure both ways
+        //
+        stats->maxDeviation = max(meshDeviation(in, out), meshDeviation(out, in));
+    }
+    return out.getNumFaces() > 0;
+}
+
+// faces of "to" are bucketed on an x-z grid of about one face per cell so
+// each vertex of "from" only tests the faces over its cell
+//
+float meshDeviation(const Mesh &from, const Mesh &to) {
+    PROFILE_SCOPE("meshDeviation");
+    if (to.getNumFaces() == 0 || from.getNumVertices() == 0) return 0;
+    float x0 = FLT_MAX, z0 = FLT_MAX, x1 = -FLT_MAX, z1 = -FLT_MAX;
+    for (int i = 0; i < to.getNumVertices(); i++) {
+        const Vec3 &v = to.getVertex(i);
+        x0 = min(x0, v.x); x1 = max(x1, v.x);
+        z0 = min(z0, v.z); z1 = max(z1, v.z);
+    }
+    int n = max(1, (int)sqrt((float)to.getNumFaces()));
+    float cw = max((x1 - x0) / n, 1e-6f), cd = max((z1 - z0) / n, 1e-6f);
+    vector<vector<int> > cells(n * n);
+    for (int f = 0; f < to.getNumFaces(); f++) {
+        const Vec3 &a = to.getFaceVertex(f, 0), &b = to.getFaceVertex(f, 1), &c = to.getFaceVertex(f, 2);
+        int i0 = max(0, (int)((min(a.x, min(b.x, c.x)) - x0) / cw));
+        int i1 = min(n - 1, (int)((max(a.x, max(b.x, c.x)) - x0) / cw));
+        int j0 = max(0, (int)((min(a.z, min(b.z, c.z)) - z0) / cd));
+        int j1 = min(n - 1, (int)((max(a.z, max(b.z, c.z)) - z0) / cd));
+        for (int j = j0; j <= j1; j++)
+            for (int i = i0; i <= i1; i++) cells[j * n + i].push_back(f);
+    }
+
+    float worst = 0;
+    for (int k = 0; k < from.getNumVertices(); k++) {
+        const Vec3 &p = from.getVertex(k);
+        int ci = min(n - 1, max(0, (int)((p.x - x0) / cw)));
+        int cj = min(n - 1, max(0, (int)((p.z - z0) / cd)));
+        float best = FLT_MAX;
+        const vector<int> &list = cells[cj * n + ci];
+        for (int i = 0; i < list.size(); i++) {
+            float h;
+            if (heightOnTriangle(p.x, p.z, to.getFaceVertex(list[i], 0), to.getFaceVertex(list[i], 1),
+                                 to.getFaceVertex(list[i], 2), h))
+                best = min(best, (float)fabs(h - p.y));
+        }
+        if (best == FLT_MAX) {
+            for (int j = max(0, cj - 1); j <= min(n - 1, cj + 1); j++) {
+                for (int i = max(0, ci - 1); i <= min(n - 1, ci + 1); i++) {
+                    const vector<int> &near = cells[j * n + i];
+                    for (int m = 0; m < near.size(); m++) {
+                        Vec3 q = closestPointOnTriangle(p, to.getFaceVertex(near[m], 0),
+                                                        to.getFaceVertex(near[m], 1), to.getFaceVertex(near[m], 2));
+                        best = min(best, q.distance(p));
+                    }
+                }
+            }
+        }
+        if (best != FLT_MAX) worst = max(worst, best);
+    }
+    return worst;
+}
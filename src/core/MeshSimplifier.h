@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Mesh.h"
+
+//  Quadric error mesh simplification (Garland and Heckbert, "Surface
+//  Simplification Using Quadric Error Metrics", 1997), used to make a
+//  lighter collision proxy of the terrain.
+//
+//  Each vertex carries the sum of the squared distance quadrics of the
+//  planes of its original faces; edges are collapsed cheapest first into
+//  the point that minimizes the merged quadric.  Collapsing stops once the
+//  cheapest one would move the surface more than maxError from any of the
+//  original planes merged into it, or when targetFaces is reached.  Mesh
+//  borders are pinned by extra perpendicular planes, and collapses that
+//  would flip a face or leave an edge longer than maxEdge (if not 0) are
+//  skipped; the octree's contact query slows down with the largest face.
+//
+class SimplifyStats {
+public:
+    int sourceFaces, faces;
+    int sourceVertices, vertices;
+    float maxDeviation;     // meshDeviation() taken both ways, the larger
+};
+
+bool simplifyMesh(const Mesh &in, Mesh &out, float maxError, float maxEdge = 0,
+                  int targetFaces = 0, SimplifyStats *stats = NULL);
+
+//  Largest vertical distance from a vertex of "from" to the surface of
+//  "to", for height field terrain (the way the contact query measures
+//  it); vertices outside every face of "to" use the distance to the
+//  closest face instead.
+//
+float meshDeviation(const Mesh &from, const Mesh &to);
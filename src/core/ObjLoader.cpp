@@ -0,0 +1,74 @@
+
+#include "ObjLoader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+// index of the position in a face corner ("12", "12/3", "12//4", "-1/...")
+//
+static bool cornerIndex(const char *&s, int numVerts, unsigned int &index) {
+    while (*s == ' ' || *s == '\t') s++;
+    if (*s == 0 || *s == '\n' || *s == '\r') return false;
+    char *end;
+    long i = strtol(s, &end, 10);
+    if (end == s) return false;
+    s = end;
+    while (*s && *s != ' ' && *s != '\t' && *s != '\n' && *s != '\r') s++;
+    if (i < 0) i += numVerts;
+    else i -= 1;
+    if (i < 0 || i >= numVerts) return false;
+    index = i;
+    return true;
+}
+
+bool loadObj(const string &path, Mesh &mesh, atomic<float> *progress, const atomic<bool> *cancel) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    mesh.vertices.clear();
+    mesh.normals.clear();
+    mesh.indices.clear();
+    vector<unsigned int> poly;
+    char line[1024];
+    int lines = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        const char *s = line;
+        if (s[0] == 'v' && s[1] == ' ') {
+            Vec3 v;
+            sscanf(s + 2, "%f %f %f", &v.x, &v.y, &v.z);
+            mesh.vertices.push_back(v);
+        }
+        else if (s[0] == 'v' && s[1] == 'n' && s[2] == ' ') {
+            Vec3 n;
+            sscanf(s + 3, "%f %f %f", &n.x, &n.y, &n.z);
+            mesh.normals.push_back(n);
+        }
+        else if (s[0] == 'f' && s[1] == ' ') {
+            s += 2;
+            poly.clear();
+            unsigned int index;
+            while (cornerIndex(s, mesh.vertices.size(), index))
+                poly.push_back(index);
+            for (int i = 2; i < poly.size(); i++) {
+                mesh.indices.push_back(poly[0]);
+                mesh.indices.push_back(poly[i - 1]);
+                mesh.indices.push_back(poly[i]);
+            }
+        }
+        if ((++lines & 4095) == 0) {
+            if (cancel && cancel->load()) break;
+            if (progress && size > 0) progress->store((float)ftell(fp) / size);
+        }
+    }
+    fclose(fp);
+    if (cancel && cancel->load()) return false;
+    if (mesh.normals.size() != mesh.vertices.size()) mesh.normals.clear();
+    if (progress) progress->store(1);
+    return mesh.vertices.size() > 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include "Mesh.h"
+
+//  Minimal Wavefront OBJ reader for geometry only: "v" and "vn" records and
+//  "f" faces (any of the v, v/t, v//n, v/t/n forms, negative indices, and
+//  polygons triangulated as fans).  Materials and texture coordinates are
+//  ignored.  Pure CPU work, so it can run on a loader thread.
+//
+//  Faces refer to positions by index as in the file, like the vertex
+//  order the model loader produces.  Normals are kept only when the file
+//  has one per position.
+//
+//  progress (optional) goes from 0 to 1 as the file is parsed.  Setting
+//  cancel (optional) stops the parse early, which then fails.
+//
+bool loadObj(const std::string &path, Mesh &mesh, std::atomic<float> *progress = NULL,
+             const std::atomic<bool> *cancel = NULL);
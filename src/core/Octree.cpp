@@ -0,0 +1,711 @@
+
+//--------------------------------------------------------------
+//
+//  Kevin M. Smith
+//
+//  Simple Octree Implementation 11/10/2020
+// 
+//  Copyright (c) by Kevin M. Smith
+//  Copying or use without permission is prohibited by law. 
+//
+
+
+#include "Octree.h"
+#include "Profiler.h"
+#include "Triangle.h"
+#include <iostream>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+#include <mutex>
+#include <limits.h>
+#include <assert.h>
+
+using namespace std;
+
+// counts a query in flight, in debug builds (see setLevels())
+//
+class Octree::QueryScope {
+public:
+#ifndef NDEBUG
+	QueryScope(const Octree &tree) : tree(tree) { tree.activeQueries.value++; }
+	~QueryScope() { tree.activeQueries.value--; }
+	const Octree &tree;
+#else
+	QueryScope(const Octree &) {}
+#endif
+};
+ 
+
+
+// return a Mesh Bounding Box for the entire Mesh
+//
+Box Octree::meshBounds(const Mesh & mesh) {
+	int n = mesh.getNumVertices();
+	Vec3 v = mesh.getVertex(0);
+	Vec3 max = v;
+	Vec3 min = v;
+	for (int i = 1; i < n; i++) {
+		const Vec3 &v = mesh.getVertex(i);
+
+		if (v.x > max.x) max.x = v.x;
+		else if (v.x < min.x) min.x = v.x;
+
+		if (v.y > max.y) max.y = v.y;
+		else if (v.y < min.y) min.y = v.y;
+
+		if (v.z > max.z) max.z = v.z;
+		else if (v.z < min.z) min.z = v.z;
+	}
+//	cout << "min: " << min << "max: " << max << endl;
+	return Box(min, max);
+}
+
+// getMeshPointsInBox:  return an array of indices to points in mesh that are contained 
+//                      inside the Box.  Return count of points found;
+//
+int Octree::getMeshPointsInBox(const Mesh & mesh, const vector<int>& points,
+	Box & box, vector<int> & pointsRtn)
+{
+	int count = 0;
+	for (int i = 0; i < points.size(); i++) {
+		const Vec3 &v = mesh.getVertex(points[i]);
+		if (box.inside(v)) {
+			count++;
+			pointsRtn.push_back(points[i]);
+		}
+	}
+	return count;
+}
+
+// getMeshFacesInBox:  return an array of indices to Faces in mesh that are contained 
+//                      inside the Box.  Return count of faces found;
+//
+int Octree::getMeshFacesInBox(const Mesh & mesh, const vector<int>& faces,
+	Box & box, vector<int> & facesRtn)
+{
+	int count = 0;
+	for (int i = 0; i < faces.size(); i++) {
+		Vec3 v[3];
+		v[0] = mesh.getFaceVertex(faces[i], 0);
+		v[1] = mesh.getFaceVertex(faces[i], 1);
+		v[2] = mesh.getFaceVertex(faces[i], 2);
+		if (box.inside(v, 3)) {
+			count++;
+			facesRtn.push_back(faces[i]);
+		}
+	}
+	return count;
+}
+
+//  Subdivide a Box into eight(8) equal size boxes, return them in boxList;
+//
+void Octree::subDivideBox8(const Box &box, vector<Box> & boxList) {
+	Vec3 min = box.min();
+	Vec3 max = box.max();
+	Vec3 size = max - min;
+	Vec3 center = size / 2 + min;
+	float xdist = (max.x - min.x) / 2;
+	float ydist = (max.y - min.y) / 2;
+	float zdist = (max.z - min.z) / 2;
+	Vec3 h = Vec3(0, ydist, 0);
+
+	//  generate ground floor
+	//
+	Box b[8];
+	b[0] = Box(min, center);
+	b[1] = Box(b[0].min() + Vec3(xdist, 0, 0), b[0].max() + Vec3(xdist, 0, 0));
+	b[2] = Box(b[1].min() + Vec3(0, 0, zdist), b[1].max() + Vec3(0, 0, zdist));
+	b[3] = Box(b[2].min() + Vec3(-xdist, 0, 0), b[2].max() + Vec3(-xdist, 0, 0));
+
+	boxList.clear();
+	for (int i = 0; i < 4; i++)
+		boxList.push_back(b[i]);
+
+	// generate second story
+	//
+	for (int i = 4; i < 8; i++) {
+		b[i] = Box(b[i - 4].min() + h, b[i - 4].max() + h);
+		boxList.push_back(b[i]);
+	}
+}
+
+// build a tree over a copy of geo
+//
+void Octree::create(const Mesh & geo, int numLevels) {
+	create(make_shared<const Mesh>(geo), numLevels);
+}
+
+void Octree::create(shared_ptr<const Mesh> geo, int numLevels) {
+	PROFILE_SCOPE("Octree::create");
+	// initialize octree structure
+	//
+	mesh = geo;
+	root = TreeNode();
+	if (!mesh) return;
+	int level = 0;
+    root.box = meshBounds(*mesh);
+	if (!bUseFaces) {
+		for (int i = 0; i < mesh->getNumVertices(); i++) {
+			root.points.push_back(i);
+            
+		}
+	}
+	else {
+		// need to load face vertices here
+		//
+	}
+	// recursively buid octree (lazy trees only the top of it)
+	//
+	level++;
+	levels.value = numLevels;
+    subdivide(*mesh, root, bLazy ? min(eagerLevels, numLevels) : numLevels, level);
+
+	// index the faces around every vertex, for contact()
+	//
+	int nv = mesh->getNumVertices();
+	vertexFaceStart.assign(nv + 1, 0);
+	for (int i = 0; i < mesh->indices.size(); i++)
+		vertexFaceStart[mesh->indices[i] + 1]++;
+	for (int v = 0; v < nv; v++)
+		vertexFaceStart[v + 1] += vertexFaceStart[v];
+	vertexFaces.resize(mesh->indices.size());
+	vector<int> fill(vertexFaceStart.begin(), vertexFaceStart.end() - 1);
+	for (int i = 0; i < mesh->indices.size(); i++)
+		vertexFaces[fill[mesh->indices[i]]++] = i / 3;
+	faceReach = 0;
+	vertexReach.assign(nv, 0);
+	for (int f = 0; f < mesh->getNumFaces(); f++) {
+		float reach = triangleReach(mesh->getFaceVertex(f, 0), mesh->getFaceVertex(f, 1),
+			mesh->getFaceVertex(f, 2));
+		faceReach = max(faceReach, reach);
+		for (int i = 0; i < 3; i++) {
+			float &r = vertexReach[mesh->indices[f * 3 + i]];
+			r = max(r, reach);
+		}
+	}
+	boundFaces(root);
+	linkNeighbors();
+	generation++;
+}
+
+// set faceBounds of node and everything under it
+//
+void Octree::boundFaces(TreeNode &node) {
+	node.faceBounds = Aabb();
+	for (int i = 0; i < node.children.size(); i++) {
+		TreeNode &child = node.children[i];
+		boundFaces(child);
+		node.faceBounds.add(child.faceBounds);
+	}
+	if (node.children.size() > 0) return;
+	for (int i = 0; i < node.points.size(); i++) {
+		int v = node.points[i];
+		if (v + 1 >= vertexFaceStart.size()) continue;
+		for (int j = vertexFaceStart[v]; j < vertexFaceStart[v + 1]; j++) {
+			for (int c = 0; c < 3; c++)
+				node.faceBounds.add(mesh->getFaceVertex(vertexFaces[j], c));
+		}
+	}
+}
+
+
+void Octree::subdivide(const Mesh & mesh, TreeNode & node, int numLevels, int level) {
+	if (level >= numLevels) return;
+	vector<Box> boxList;
+	subDivideBox8(node.box, boxList);
+	level++;
+	int pointsInNode = node.points.size();
+	int totalPoints = 0;
+	for (int i = 0; i < boxList.size(); i++) {
+		TreeNode child;
+		int count = 0;
+		if (!bUseFaces)
+			count = getMeshPointsInBox(mesh, node.points, boxList[i], child.points);
+		else 
+			count = getMeshFacesInBox(mesh, node.points, boxList[i], child.points);
+		totalPoints += count;
+
+		if (count > 0) {
+			child.box = boxList[i];
+			child.level = level;
+			node.children.push_back(child);
+			if (count > 1) {
+				subdivide(mesh, node.children.back(), numLevels, level);
+			}
+		}
+
+	
+	}
+	// debug
+	//
+	if (pointsInNode != totalPoints) {
+		strayVerts += (pointsInNode - totalPoints);
+	}
+}
+
+// Implement functions below for Homework project
+//
+
+bool Octree::intersect(const Ray &ray, const TreeNode & node, TreeNode & nodeRtn) {
+    if (!mesh) return false;        // not built yet
+    if(node.box.intersect(ray, 0, 1000)){
+        visit(node);
+        if(node.children.size() == 0){
+            nodeRtn = node;
+            return true;
+        }
+        else{
+            for(int i = 0; i < node.children.size(); i++){
+                if(intersect(ray, node.children[i], nodeRtn)){
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+bool Octree::intersect(const Box &box, TreeNode & node, vector<Box> & boxListRtn) {
+    if(node.box.overlap(box)){
+        visit(node);
+        if(node.children.size() == 0){
+            boxListRtn.push_back(node.box);
+            return true;
+        }
+        else{
+            for(int i = 0; i < node.children.size(); i++){
+                intersect(box, node.children[i], boxListRtn);
+            }
+            return boxListRtn.size() > 0;
+        }
+    }
+    return false;
+}
+
+bool Octree::intersect(const Vec3 &point, TreeNode &node) {
+    visit(node);
+    if (node.children.size() == 0) {
+        if (node.points.size() == 0) {
+            return false;
+        }
+        return node.box.inside(point);
+    }
+    for (int i = 0; i < node.children.size(); ++i) {
+        TreeNode &currentChild = node.children[i];
+        if (currentChild.box.inside(point)){
+            return intersect(point, currentChild);
+        }
+    }
+    return false;
+}
+
+// leaf containing point, NULL if the point is outside the tree
+//
+const TreeNode *Octree::findLeaf(const Vec3 &point) const {
+	QueryScope scope(*this);
+	visit(root);
+	if (root.children.size() == 0)
+		return root.box.inside(point) ? &root : NULL;
+	const TreeNode *node = &root;
+	while (node->children.size() > 0) {
+		const TreeNode *next = NULL;
+		for (int i = 0; i < node->children.size(); i++) {
+			if (node->children[i].box.inside(point)) {
+				next = &node->children[i];
+				break;
+			}
+		}
+		if (next == NULL) return NULL;
+		node = next;
+		visit(*node);
+	}
+	return node;
+}
+
+// node among parent's children whose box holds p, parent itself if none
+//
+static TreeNode *childAt(TreeNode *parent, const Vec3 &p) {
+	for (int i = 0; i < parent->children.size(); i++) {
+		if (parent->children[i].box.inside(p))
+			return &parent->children[i];
+	}
+	return parent;
+}
+
+// set the parent and face neighbor links of node's children, from
+// node's own.  The neighbor across a face is found in the parent when
+// the box next door is inside it, otherwise in the parent's own
+// neighbor; where that region was never subdivided (no points, or not
+// yet in a lazy tree), the link stops at the coarser node that covers it.
+//
+static void linkChildren(TreeNode *node) {
+	for (int i = 0; i < node->children.size(); i++) {
+		TreeNode *child = &node->children[i];
+		child->parent = node;
+		Vec3 size = child->box.max() - child->box.min();
+		Vec3 center = child->box.center();
+		for (int d = 0; d < 6; d++) {
+			Vec3 next = center;
+			float step = (d & 1) ? 1 : -1;
+			if (d / 2 == 0) next.x += step * size.x;
+			else if (d / 2 == 1) next.y += step * size.y;
+			else next.z += step * size.z;
+
+			TreeNode *across = node->box.inside(next) ? node : node->neighbors[d];
+			child->neighbors[d] = across ? childAt(across, next) : NULL;
+		}
+	}
+}
+
+// set parent and face neighbor links of the whole tree, top down so a
+// node's parent is linked before it
+//
+void Octree::linkNeighbors() {
+	root.parent = NULL;
+	for (int d = 0; d < 6; d++) root.neighbors[d] = NULL;
+	vector<TreeNode *> queue;
+	queue.push_back(&root);
+	for (int q = 0; q < queue.size(); q++) {
+		TreeNode *node = queue[q];
+		linkChildren(node);
+		for (int i = 0; i < node->children.size(); i++)
+			queue.push_back(&node->children[i]);
+	}
+}
+
+// subdivide node one level if a lazy tree at its current depth calls for
+// it.  Queries are const and may run on several threads, so the tree
+// grows under them: only here, under expandLock, and a node's children
+// are complete before its expanded mark (which visit() reads without the
+// lock) says so.  Children never change once made, and links from
+// elsewhere to node stay valid, just coarser than they could be.
+//
+void Octree::expand(const TreeNode &node) const {
+	lock_guard<mutex> lock(expandLock.mutex);
+	int depth = levels.value.load();
+	if (node.expanded.value.load(memory_order_relaxed) >= depth) return;
+	Octree *tree = const_cast<Octree *>(this);
+	TreeNode &n = const_cast<TreeNode &>(node);
+	if (n.children.empty() && n.level < depth && n.points.size() > 1) {
+		tree->subdivide(*mesh, n, n.level + 1, n.level);
+		linkChildren(&n);
+		for (int i = 0; i < n.children.size(); i++)
+			tree->boundFaces(n.children[i]);
+	}
+	n.expanded.value.store(n.children.empty() ? depth : INT_MAX, memory_order_release);
+}
+
+void Octree::expandAll(const TreeNode &node) {
+	expand(node);
+	for (int i = 0; i < node.children.size(); i++)
+		expandAll(node.children[i]);
+}
+
+// change the depth of a built tree without rebuilding it.  Deeper
+// settings subdivide the current leaves further, right away for eager
+// trees (which must not be queried meanwhile) and as queries reach them
+// for lazy ones; a shallower setting only stops lazy trees from going
+// deeper, nodes already made stay.
+//
+void Octree::setLevels(int numLevels) {
+	assert(activeQueries.value.load() == 0);
+	levels.value = numLevels;
+	if (!bLazy && mesh) expandAll(root);
+}
+
+// findLeaf() starting from where the cursor's last query ended.  If the
+// point has left that node, step across the face it left through until
+// a node holds it (a few steps at most for anything moving less than a
+// leaf per frame), then descend from there.  Only when the walk runs off
+// the tree or takes too long does the search restart at the root.  The
+// cursor keeps the deepest node reached even when it is not a leaf, so a
+// point hovering over empty space is also cheap.
+//
+const TreeNode *Octree::findLeaf(const Vec3 &point, OctreeCursor &cursor) const {
+	QueryScope scope(*this);
+	if (cursor.tree != this || cursor.generation != generation) {
+		cursor.reset();
+		cursor.tree = this;
+		cursor.generation = generation;
+	}
+	cursor.queries++;
+	if (!root.box.inside(point)) return NULL;
+
+	const TreeNode *node = cursor.node;
+	for (int steps = 0; node != NULL && steps < 8 && !node->box.inside(point); steps++) {
+		Vec3 min = node->box.min(), max = node->box.max();
+		int face = 0;
+		float furthest = 0;
+		for (int axis = 0; axis < 3; axis++) {
+			float size = max[axis] - min[axis];
+			if (size <= 0) continue;
+			float below = (min[axis] - point[axis]) / size;
+			float above = (point[axis] - max[axis]) / size;
+			if (below > furthest) { furthest = below; face = axis * 2; }
+			if (above > furthest) { furthest = above; face = axis * 2 + 1; }
+		}
+		node = node->neighbors[face];
+	}
+	if (node == NULL || !node->box.inside(point)) {
+		cursor.rootDescents++;
+		node = &root;
+	}
+	visit(*node);
+	while (node->children.size() > 0) {
+		const TreeNode *next = NULL;
+		for (int i = 0; i < node->children.size(); i++) {
+			if (node->children[i].box.inside(point)) {
+				next = &node->children[i];
+				break;
+			}
+		}
+		if (next == NULL) break;
+		node = next;
+		visit(*node);
+	}
+	cursor.node = node;
+	return node->children.size() == 0 ? node : NULL;
+}
+
+// running choice of contact face for a point: the face under (or over)
+// it if there is one, otherwise the closest.  Faces that miss are only
+// measured once it is known that none covers the point; usually one does
+// and the closest point tests are never needed.
+//
+class FacePick {
+public:
+	FacePick(const Mesh &mesh, const Vec3 &point) : mesh(mesh), point(point),
+		under(-1), closest(-1), underDist(FLT_MAX), closestDist(FLT_MAX), misses(0) {}
+
+	void add(int f) {
+		const Vec3 &a = mesh.getFaceVertex(f, 0);
+		const Vec3 &b = mesh.getFaceVertex(f, 1);
+		const Vec3 &c = mesh.getFaceVertex(f, 2);
+		float h;
+		if (heightOnTriangle(point.x, point.z, a, b, c, h)) {
+			if (fabs(h - point.y) < underDist) {
+				underDist = fabs(h - point.y);
+				under = f;
+			}
+		}
+		else if (under < 0) {
+			if (misses < MaxMisses) missed[misses++] = f;
+			else measure(f);
+		}
+	}
+
+	void measure(int f) {
+		Vec3 q = closestPointOnTriangle(point, mesh.getFaceVertex(f, 0),
+			mesh.getFaceVertex(f, 1), mesh.getFaceVertex(f, 2));
+		float d2 = q.squareDistance(point);
+		if (d2 < closestDist) {
+			closestDist = d2;
+			closest = f;
+			closestPoint = q;
+		}
+	}
+
+	// fill in the face, normal, depth and surface point
+	//
+	void finish(Contact &c) {
+		if (under < 0)
+			for (int i = 0; i < misses; i++) measure(missed[i]);
+		c.triangle = under >= 0 ? under : closest;
+		if (c.triangle < 0) return;
+
+		const Vec3 &a = mesh.getFaceVertex(c.triangle, 0);
+		Vec3 n = (mesh.getFaceVertex(c.triangle, 1) - a).cross(mesh.getFaceVertex(c.triangle, 2) - a);
+		if (n.y < 0) n = -n;
+		if (n.lengthSquared() > 0) c.normal = n.getNormalized();
+
+		// distance to the face's plane along the normal
+		//
+		c.depth = (a - point).dot(c.normal);
+		c.point = under >= 0 ? point + c.normal * c.depth : closestPoint;
+	}
+
+	const Mesh &mesh;
+	Vec3 point;
+	int under, closest;
+	float underDist, closestDist;
+	Vec3 closestPoint;
+	static const int MaxMisses = 256;
+	int missed[MaxMisses];
+	int misses;
+};
+
+// single traversal of the vertical column around the point: it finds
+// whether the point's own leaf holds terrain (hit, same meaning as
+// intersect(point, root)) and collects the faces of every vertex within
+// faceReach in x and z.  The terrain is a height field, so the face under
+// (or over) the point gives the contact; if none covers it, the closest
+// face does.
+//
+bool Octree::contact(const Vec3 &point, Contact &c) const {
+	PROFILE_SCOPE("Octree::contact");
+	QueryScope scope(*this);
+	c = Contact();
+	c.point = point;
+	if (!mesh) return false;
+	FacePick pick(*mesh, point);
+	float r = faceReach;
+
+	Aabb window(Vec3(point.x - r, -FLT_MAX, point.z - r), Vec3(point.x + r, FLT_MAX, point.z + r));
+	const TreeNode *stack[64 * 8];
+	int top = 0;
+	stack[top++] = &root;
+	while (top > 0) {
+		const TreeNode *node = stack[--top];
+		if (!node->box.bounds.overlaps(window)) continue;
+		visit(*node);
+		if (node->children.size() > 0) {
+			for (int i = 0; i < node->children.size() && top < 64 * 8; i++)
+				stack[top++] = &node->children[i];
+			continue;
+		}
+		if (node->points.size() > 0 && node->box.inside(point)) c.hit = true;
+		for (int i = 0; i < node->points.size(); i++) {
+			int v = node->points[i];
+			if (v + 1 >= vertexFaceStart.size()) continue;
+			const Vec3 &p = mesh->getVertex(v);
+			float rv = vertexReach[v];
+			if (fabs(p.x - point.x) > rv || fabs(p.z - point.z) > rv) continue;
+			for (int k = vertexFaceStart[v]; k < vertexFaceStart[v + 1]; k++)
+				pick.add(vertexFaces[k]);
+		}
+	}
+	if (!c.hit) return false;
+	pick.finish(c);
+	return true;
+}
+
+// same result as contact() above for a body that moves a little each
+// frame.  The hit test walks from the cursor's last node, and the faces
+// of a column twice as wide are kept in the cursor and reused until the
+// point has moved faceReach away from where they were gathered, so most
+// frames touch neither the root nor the column.
+//
+bool Octree::contact(const Vec3 &point, Contact &c, OctreeCursor &cursor) const {
+	PROFILE_SCOPE("Octree::contact (cursor)");
+	QueryScope scope(*this);
+	c = Contact();
+	c.point = point;
+	const TreeNode *leaf = findLeaf(point, cursor);
+	c.hit = leaf != NULL && leaf->points.size() > 0;
+	if (!c.hit) return false;
+
+	float r = faceReach;
+	if (!cursor.facesValid || fabs(point.x - cursor.facesCenter.x) > r ||
+		fabs(point.z - cursor.facesCenter.z) > r) {
+		cursor.faces.clear();
+		cursor.facesCenter = point;
+		cursor.facesValid = true;
+		cursor.faceRefreshes++;
+		float reach = 2 * r;
+		Aabb window(Vec3(point.x - reach, -FLT_MAX, point.z - reach), Vec3(point.x + reach, FLT_MAX, point.z + reach));
+
+		const TreeNode *stack[64 * 8];
+		int top = 0;
+		stack[top++] = &root;
+		while (top > 0) {
+			const TreeNode *node = stack[--top];
+			if (!node->box.bounds.overlaps(window)) continue;
+			visit(*node);
+			if (node->children.size() > 0) {
+				for (int i = 0; i < node->children.size() && top < 64 * 8; i++)
+					stack[top++] = &node->children[i];
+				continue;
+			}
+			for (int i = 0; i < node->points.size(); i++) {
+				int v = node->points[i];
+				if (v + 1 >= vertexFaceStart.size()) continue;
+				const Vec3 &p = mesh->getVertex(v);
+				float rv = vertexReach[v] + r;
+				if (fabs(p.x - point.x) > rv || fabs(p.z - point.z) > rv) continue;
+				for (int k = vertexFaceStart[v]; k < vertexFaceStart[v + 1]; k++)
+					cursor.faces.push_back(vertexFaces[k]);
+			}
+		}
+		sort(cursor.faces.begin(), cursor.faces.end());
+		cursor.faces.erase(unique(cursor.faces.begin(), cursor.faces.end()), cursor.faces.end());
+	}
+
+	FacePick pick(*mesh, point);
+	for (int i = 0; i < cursor.faces.size(); i++)
+		pick.add(cursor.faces[i]);
+	pick.finish(c);
+	return true;
+}
+
+// nearest face crossed by the ray origin + t dir, 0 <= t <= maxDist, with
+// dir unit length.  A face is indexed by the leaves of its vertices, so
+// the (four wide) slab tests use each node's face bounds, not its box.  Nodes
+// are walked nearest entry first and the walk stops at nodes the ray
+// only enters beyond the best hit so far.
+//
+bool Octree::raycast(const Vec3 &origin, const Vec3 &dir, float maxDist, RayHit &hit) const {
+	QueryScope scope(*this);
+	hit = RayHit();
+	if (!mesh) return false;
+	Ray4 ray(origin, dir);
+	float best = maxDist;
+
+	class Entry {
+	public:
+		const TreeNode *node;
+		float t;
+	};
+	Entry stack[64 * 8];
+	int top = 0;
+	float t;
+	if (!root.faceBounds.enter(ray, best, t)) return false;
+	stack[top].node = &root;
+	stack[top++].t = t;
+	while (top > 0) {
+		Entry e = stack[--top];
+		if (e.t > best) continue;
+		const TreeNode *node = e.node;
+		visit(*node);
+		if (node->children.size() > 0) {
+
+			// push the children farthest first so the nearest is walked next
+			//
+			Entry near[8];
+			int n = 0;
+			for (int i = 0; i < node->children.size() && i < 8; i++) {
+				const TreeNode &child = node->children[i];
+				if (!child.faceBounds.enter(ray, best, t)) continue;
+				int k = n++;
+				for (; k > 0 && near[k - 1].t < t; k--) near[k] = near[k - 1];
+				near[k].node = &child;
+				near[k].t = t;
+			}
+			for (int i = 0; i < n && top < 64 * 8; i++) stack[top++] = near[i];
+			continue;
+		}
+		for (int i = 0; i < node->points.size(); i++) {
+			int v = node->points[i];
+			if (v + 1 >= vertexFaceStart.size()) continue;
+			for (int k = vertexFaceStart[v]; k < vertexFaceStart[v + 1]; k++) {
+				int f = vertexFaces[k];
+				if (rayTriangle(origin, dir, mesh->getFaceVertex(f, 0), mesh->getFaceVertex(f, 1),
+					mesh->getFaceVertex(f, 2), t) && t <= best) {
+					best = t;
+					hit.hit = true;
+					hit.triangle = f;
+				}
+			}
+		}
+	}
+	if (!hit.hit) return false;
+
+	const Vec3 &a = mesh->getFaceVertex(hit.triangle, 0);
+	Vec3 n = (mesh->getFaceVertex(hit.triangle, 1) - a).cross(mesh->getFaceVertex(hit.triangle, 2) - a);
+	if (n.dot(dir) > 0) n = -n;
+	if (n.lengthSquared() > 0) hit.normal = n.getNormalized();
+	hit.distance = best;
+	hit.point = origin + dir * best;
+	return true;
+}
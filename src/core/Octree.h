@@ -0,0 +1,213 @@
+
+//--------------------------------------------------------------
+//
+//  Kevin M. Smith
+//
+//  Simple Octree Implementation 11/10/2020
+// 
+//  Copyright (c) by Kevin M. Smith
+//  Copying or use without permission is prohibited by law.
+//
+#pragma once
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mesh.h"
+#include "box.h"
+#include "ray.h"
+
+
+
+// atomic int that copies its value, so the classes holding one stay
+// copyable (copies are only made while no other thread uses them)
+//
+class AtomicLevel {
+public:
+	AtomicLevel(int n = 0) : value(n) {}
+	AtomicLevel(const AtomicLevel &a) : value(a.value.load()) {}
+	AtomicLevel &operator=(const AtomicLevel &a) { value = a.value.load(); return *this; }
+	std::atomic<int> value;
+};
+
+// mutex that copies as a new, unlocked one, for the same reason
+//
+class CopyableMutex {
+public:
+	CopyableMutex() {}
+	CopyableMutex(const CopyableMutex &) {}
+	CopyableMutex &operator=(const CopyableMutex &) { return *this; }
+	std::mutex mutex;
+};
+
+class TreeNode {
+public:
+	TreeNode() : parent(NULL), level(1) {
+		for (int i = 0; i < 6; i++) neighbors[i] = NULL;
+	}
+	Box box;
+	std::vector<int> points;
+	std::vector<TreeNode> children;
+
+	// links set by Octree::create() once the tree is built: the parent and,
+	// across each face (-x, +x, -y, +y, -z, +z), the smallest node of at
+	// least this size, or NULL at the edge of the tree
+	//
+	TreeNode *parent;
+	TreeNode *neighbors[6];
+
+	// bounds of every face around the node's vertices (empty when it has
+	// none), for ray queries
+	//
+	Aabb faceBounds;
+
+	// depth, the root being 1, and for lazy trees (see Octree::bLazy) the
+	// tree depth this node was last expanded for
+	//
+	int level;
+	AtomicLevel expanded;
+};
+
+//  Result of a point contact query against the terrain.  depth is signed
+//  along the normal: positive when the point is below the surface,
+//  negative for the distance above it.
+//
+class Contact {
+public:
+	Contact() : hit(false), depth(0), normal(0, 1, 0), triangle(-1) {}
+	bool hit;           // the point's leaf holds terrain (see intersect())
+	float depth;
+	Vec3 normal;        // face normal, pointing up out of the terrain
+	Vec3 point;         // closest point on the surface
+	int triangle;       // face index in the mesh, -1 if no faces
+};
+
+//  Result of a ray query against the terrain: the nearest face the ray
+//  crosses.  The normal faces back toward the ray's origin.
+//
+class RayHit {
+public:
+	RayHit() : hit(false), distance(0), normal(0, 1, 0), triangle(-1) {}
+	bool hit;
+	float distance;     // along the (unit) ray direction
+	Vec3 point;
+	Vec3 normal;
+	int triangle;
+};
+
+//  Per client query state for temporally coherent lookups.  Each moving
+//  body keeps its own cursor; a query first checks the node the last one
+//  ended in, then walks neighbor links, and only descends from the root
+//  when the walk gets lost.  Contact queries also keep the faces around
+//  the last column and reuse them while the point stays close.  A cursor
+//  notices when its tree is rebuilt and starts over.
+//
+class Octree;
+
+class OctreeCursor {
+public:
+	OctreeCursor() { reset(); }
+	void reset() {
+		tree = NULL;
+		generation = 0;
+		node = NULL;
+		faces.clear();
+		facesValid = false;
+		queries = rootDescents = faceRefreshes = 0;
+	}
+	const Octree *tree;
+	int generation;
+	const TreeNode *node;       // deepest node that held the last point
+	std::vector<int> faces;     // faces near facesCenter
+	Vec3 facesCenter;
+	bool facesValid;
+	int queries, rootDescents, faceRefreshes;   // stats
+};
+
+class Octree {
+public:
+	
+	void create(std::shared_ptr<const Mesh> mesh, int numLevels);
+	void create(const Mesh & mesh, int numLevels);
+	void subdivide(const Mesh & mesh, TreeNode & node, int numLevels, int level);
+	bool intersect(const Ray &, const TreeNode & node, TreeNode & nodeRtn);
+	bool intersect(const Box &, TreeNode & node, std::vector<Box> & boxListRtn);
+	static Box meshBounds(const Mesh &);
+	int getMeshPointsInBox(const Mesh &mesh, const std::vector<int> & points, Box & box, std::vector<int> & pointsRtn);
+	int getMeshFacesInBox(const Mesh &mesh, const std::vector<int> & faces, Box & box, std::vector<int> & facesRtn);
+	void subDivideBox8(const Box &b, std::vector<Box> & boxList);
+
+	// the mesh the tree indexes.  It is shared and never changed once the
+	// tree is built, so trees over the same geometry (and copies of a
+	// tree) hold one copy of it between them, and it lives as long as any
+	// of them does.  NULL until create()
+	//
+	std::shared_ptr<const Mesh> mesh;
+	TreeNode root;
+	bool bUseFaces = false;
+
+	// lazy trees build only their top eagerLevels levels in create(); a
+	// node below is subdivided the first time a query reaches it, once,
+	// even with queries running on several threads.  Set before create()
+	//
+	bool bLazy = false;
+	int eagerLevels = 3;
+
+    bool intersect(const Vec3 &point, TreeNode &node);
+	const TreeNode *findLeaf(const Vec3 &point) const;
+	const TreeNode *findLeaf(const Vec3 &point, OctreeCursor &cursor) const;
+	bool contact(const Vec3 &point, Contact &contactRtn) const;
+	bool contact(const Vec3 &point, Contact &contactRtn, OctreeCursor &cursor) const;
+	bool raycast(const Vec3 &origin, const Vec3 &dir, float maxDist, RayHit &hitRtn) const;
+	void linkNeighbors();
+	void boundFaces(TreeNode &node);
+	// deepens or limits a built tree.  No query may run meanwhile, on any
+	// thread, lazy tree or not: a deeper setting subdivides leaves that a
+	// query in flight reads without the lock (debug builds assert this)
+	//
+	void setLevels(int numLevels);
+	int getLevels() const { return levels.value.load(); }
+
+	// faces around each vertex (faces of vertex v are
+	// vertexFaces[vertexFaceStart[v]] up to vertexFaceStart[v + 1])
+	//
+	std::vector<int> vertexFaceStart;
+	std::vector<int> vertexFaces;
+	float faceReach = 0;    // largest x or z extent of any face
+	std::vector<float> vertexReach;     // largest x or z extent of the faces around each vertex
+
+	// for a tree built from a simplified stand-in of the terrain (see
+	// simplifyMesh()), the largest distance between the two surfaces
+	//
+	float maxDeviation = 0;
+	// debug;
+	//
+	int strayVerts= 0;
+	int numLeaf = 0;
+
+	// bumped by create(); the links above point into this tree, so a
+	// copy has to call linkNeighbors() again before cursors can use it
+	//
+	int generation = 0;
+
+private:
+	void visit(const TreeNode &node) const {
+		if (bLazy && node.expanded.value.load(std::memory_order_acquire) < levels.value.load(std::memory_order_relaxed))
+			expand(node);
+	}
+	void expand(const TreeNode &node) const;
+	void expandAll(const TreeNode &node);
+	AtomicLevel levels;
+
+	// held while a lazy node is expanded; each node takes it at most once
+	// per depth setting, so it is rarely contended
+	//
+	mutable CopyableMutex expandLock;
+
+	// queries in flight, counted in debug builds for setLevels()
+	//
+	class QueryScope;
+	mutable AtomicLevel activeQueries;
+};
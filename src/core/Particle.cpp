@@ -11,30 +11,18 @@ Particle::Particle() {
     forces.set(0, 0, 0);
     lifespan = 5;
     birthtime = 0;
+    serial = 0;
     radius = .1;
     damping = .99;
     mass = 1;
-    color = ofColor::aquamarine;
-}
-
-void Particle::draw() {
-    ofSetColor(color);
-//    ofSetColor(ofMap(age(), 0, lifespan, 255, 10), 0, 0);
-    ofDrawSphere(position, radius);
+    color = Color(127, 255, 212);   // aquamarine
 }
 
 // write your own integrator here.. (hint: it's only 3 lines of code)
 //
-void Particle::integrate() {
-
-    // check for 0 framerate to avoid divide errors
-    //
-    float framerate = ofGetFrameRate();
-    if (framerate < 1.0) return;
-
-    // interval for this step
-    //
-    float dt = 1.0 / framerate;
+// dt is the interval for this step in seconds
+//
+void Particle::integrate(float dt) {
 
     // update position based on velocity
     //
@@ -43,7 +31,7 @@ void Particle::integrate() {
     // update acceleration with accumulated paritcles forces
     // remember :  (f = ma) OR (a = 1/m * f)
     //
-    ofVec3f accel = acceleration;    // start with any acceleration already on the particle
+    Vec3 accel = acceleration;    // start with any acceleration already on the particle
     accel += (forces * (1.0 / mass));
     velocity += accel * dt;
 
@@ -56,10 +44,9 @@ void Particle::integrate() {
     forces.set(0, 0, 0);
 }
 
-//  return age in seconds
+//  return age in seconds, given the current clock time in ms
 //
-float Particle::age() {
-    return (ofGetElapsedTimeMillis() - birthtime)/1000.0;
+float Particle::age(float now) {
+    return (now - birthtime)/1000.0;
 }
 
-
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Vec3.h"
+#include "Color.h"
+
+class ParticleForceField;
+
+class Particle {
+public:
+    Particle();
+
+    Vec3    position;
+    Vec3    velocity;
+    Vec3    acceleration;
+    Vec3    forces;
+    float    damping;
+    float   mass;
+    float   lifespan;
+    float   radius;
+    float   birthtime;
+    unsigned serial;        // spawn order in its system, set by ParticleSystem
+    void    integrate(float dt);
+    float   age(float now);        // sec, now in ms
+    Color   color;
+};
+
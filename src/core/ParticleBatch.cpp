@@ -0,0 +1,18 @@
+
+#include "ParticleBatch.h"
+
+int ParticleBatch::pack(const std::vector<Particle> &particles) {
+    count = particles.size();
+    if (positions.size() < count) {
+        positions.resize(count);
+        radii.resize(count);
+        colors.resize(count);
+    }
+    for (int i = 0; i < count; i++) {
+        const Particle &p = particles[i];
+        positions[i] = p.position;
+        radii[i] = p.radius;
+        colors[i] = FloatColor(p.color);
+    }
+    return count;
+}
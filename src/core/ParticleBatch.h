@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+#include "Color.h"
+#include "Particle.h"
+
+//  Flat, draw ready copy of a particle cloud.
+//
+//  pack() copies position, radius and color of every live particle into
+//  arrays the renderer can upload as is.  It is pure CPU work, so it can be
+//  built and timed headless.  The arrays only ever grow, so once warmed up
+//  packing does not allocate.
+//
+class ParticleBatch {
+public:
+    ParticleBatch() : count(0) {}
+    int pack(const std::vector<Particle> &particles);
+
+    std::vector<Vec3> positions;
+    std::vector<float> radii;
+    std::vector<FloatColor> colors;
+    int count;          // particles packed by the last call
+};
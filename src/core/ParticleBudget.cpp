@@ -0,0 +1,50 @@
+
+#include "ParticleBudget.h"
+#include <algorithm>
+
+using namespace std;
+
+ParticleBudget::ParticleBudget(float target) {
+    targetMillis = target;
+    minLevel = .2;
+    headroom = .8;
+    recoverRate = .01;
+    maxSlices = 4;
+    reset();
+}
+
+void ParticleBudget::reset() {
+    level = 1;
+    averageMillis = 0;
+}
+
+// smooth the frame time and move the level.  going down is proportional
+// to the overshoot so a heavy spike sheds load quickly; coming back up is
+// a fixed small step so the effect fades back in without oscillating.
+//
+void ParticleBudget::frame(float millis) {
+    if (averageMillis == 0) averageMillis = millis;
+    else averageMillis = averageMillis * .9f + millis * .1f;
+
+    if (averageMillis > targetMillis) {
+        float over = (averageMillis - targetMillis) / averageMillis;
+        level -= level * over * .1f;
+    }
+    else if (averageMillis < targetMillis * headroom) {
+        level += recoverRate;
+    }
+    level = max(minLevel, min(1.0f, level));
+}
+
+int ParticleBudget::cap(int capacity) const {
+    return (int)(capacity * level);
+}
+
+// full fidelity updates every particle every frame, below that far
+// particles are spread over up to maxSlices frames
+//
+int ParticleBudget::slices() const {
+    if (level >= 1 || minLevel >= 1) return 1;
+    float t = (1 - level) / (1 - minLevel);
+    return 1 + (int)(t * (maxSlices - 1) + .5f);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+//  Frame time budget for particle effects.
+//
+//  Fed the cost of each frame, it keeps a fidelity level between minLevel
+//  and 1.  The level drops in proportion to how far the smoothed frame
+//  time is over target and climbs back slowly once there is headroom, so
+//  effects thin out gradually under load instead of the frame rate
+//  falling off a cliff.  Systems and emitters read the level through
+//  cap(), emission() and slices().
+//
+class ParticleBudget {
+public:
+    ParticleBudget(float targetMillis = 12);
+    void frame(float millis);           // report the work time of the last frame
+    void reset();
+    int cap(int capacity) const;        // live particles allowed out of capacity
+    float emission() const { return level; }  // fraction of the full emission rate
+    int slices() const;                 // frames a far particle's update is spread over
+
+    float targetMillis;     // frame work time to stay under
+    float minLevel;         // never degrade below this
+    float headroom;         // recover once average is under target * headroom
+    float recoverRate;      // level regained per frame with headroom
+    int maxSlices;          // update far particles every maxSlices frames at worst
+    float level;            // current fidelity, 1 = full
+    float averageMillis;    // smoothed frame work time
+};
@@ -0,0 +1,190 @@
+
+//  Kevin M. Smith - CS 134 SJSU
+
+#include "ParticleEmitter.h"
+#include "Profiler.h"
+#include <iostream>
+#include <stdlib.h>
+#include <algorithm>
+
+using namespace std;
+
+ParticleEmitter::ParticleEmitter() {
+    sys = new ParticleSystem();
+    createdSys = true;
+    init();
+}
+
+ParticleEmitter::ParticleEmitter(ParticleSystem *s) {
+    if (s == NULL)
+    {
+        cout << "fatal error: null particle system passed to ParticleEmitter()" << endl;
+        exit(1);
+    }
+    sys = s;
+    createdSys = false;
+    init();
+}
+
+ParticleEmitter::~ParticleEmitter() {
+    
+    // deallocate particle system if emitter created one internally
+    //
+    if (createdSys) delete sys;
+}
+
+void ParticleEmitter::init() {
+    rate = 1;
+    velocity = Vec3(0, 20, 0);
+    lifespan = 3;
+    mass = 1;
+    randomLife = false;
+    lifeMinMax = Vec3(2, 4);
+    started = false;
+    oneShot = false;
+    fired = false;
+    lastSpawned = 0;
+    radius = 1;
+    particleRadius = .1;
+    visible = true;
+    type = DirectionalEmitter;
+    groupSize = 1;
+    damping = .99;
+    particleColor = Color(255, 165, 0);     // orange
+    position = Vec3(0,0,0);
+}
+
+
+
+void ParticleEmitter::start() {
+    if (started) return;
+    started = true;
+    lastSpawned = sys->getClock()->elapsedMillis();
+}
+
+void ParticleEmitter::stop() {
+    started = false;
+    fired = false;
+}
+void ParticleEmitter::update() {
+    PROFILE_SCOPE("ParticleEmitter::update");
+    
+    float time = sys->getClock()->elapsedMillis();
+
+    // a particle budget under load thins out the emission by shrinking
+    // the groups (the rate is usually above the frame rate, so fewer
+    // groups per second would not change anything)
+    //
+    int group = groupSize;
+    if (sys->budget) group = max(1, (int)(groupSize * sys->budget->emission() + .5f));
+    
+    if (oneShot && started) {
+        if (!fired) {
+            
+            // spawn a new particle(s)
+            //
+            spawnBatch(time, group);
+            
+            lastSpawned = time;
+        }
+        fired = true;
+        stop();
+    }
+    
+    else if (((time - lastSpawned) > (1000.0 / rate)) && started) {
+        
+        // spawn a new particle(s)
+        //
+        spawnBatch(time, group);
+        
+        lastSpawned = time;
+    }
+    
+    sys->update();
+}
+
+// spawn a single particle.  time is current time of birth
+//
+void ParticleEmitter::spawn(float time) {
+    spawnBatch(time, 1);
+}
+
+// spawn a group of n particles directly into the system's pool.  The emitter
+// type is resolved once for the whole group and each type has its own loop,
+// so there is no per particle switch and no temporary Particle to copy.
+//
+void ParticleEmitter::spawnBatch(float time, int n) {
+    int first = sys->allocate(n);
+    n = sys->particles.size() - first;
+    if (n <= 0) return;
+    Particle *p = &sys->particles[first];
+
+    // set initial velocity and position
+    // based on emitter type
+    //
+    switch (type) {
+        case RadialEmitter:
+            spawnRadial(p, n);
+            break;
+        case SphereEmitter:
+            spawnSphere(p, n);
+            break;
+        case DirectionalEmitter:
+            spawnDirectional(p, n);
+            break;
+        case DiscEmitter:   // x-z plane
+            spawnDisc(p, n);
+            break;
+    }
+
+    // other particle attributes
+    //
+    for (int i = 0; i < n; i++) {
+        if (randomLife) {
+            p[i].lifespan = sys->random.uniform(lifeMinMax.x, lifeMinMax.y);
+        }
+        else p[i].lifespan = lifespan;
+        p[i].acceleration.set(0, 0, 0);
+        p[i].forces.set(0, 0, 0);
+        p[i].birthtime = time;
+        p[i].radius = particleRadius;
+        p[i].mass = mass;
+        p[i].damping = damping;
+        p[i].color = particleColor;
+    }
+}
+
+void ParticleEmitter::spawnDirectional(Particle *p, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i].velocity = velocity;
+        p[i].position = position;
+    }
+}
+
+void ParticleEmitter::spawnRadial(Particle *p, int n) {
+    SquaresRandom &rnd = sys->random;
+    float speed = velocity.length();
+    for (int i = 0; i < n; i++) {
+        Vec3 dir = Vec3(rnd.uniform(-1, 1), rnd.uniform(-1, 1), rnd.uniform(-1, 1));
+        p[i].velocity = dir.getNormalized() * speed;
+        p[i].position = position;
+    }
+}
+
+void ParticleEmitter::spawnDisc(Particle *p, int n) {
+    SquaresRandom &rnd = sys->random;
+    for (int i = 0; i < n; i++) {
+        Vec3 dir = Vec3(rnd.uniform(-1, 1), rnd.uniform(-.2, .2), rnd.uniform(-1, 1));
+        p[i].position = position + (dir.getNormalized() * radius);
+        p[i].velocity = velocity;
+    }
+}
+
+// not implemented as yet - particles start at rest at the origin
+//
+void ParticleEmitter::spawnSphere(Particle *p, int n) {
+    for (int i = 0; i < n; i++) {
+        p[i].position.set(0, 0, 0);
+        p[i].velocity.set(0, 0, 0);
+    }
+}
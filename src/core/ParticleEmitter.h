@@ -15,39 +15,44 @@ public:
     ParticleEmitter(ParticleSystem *s);
     ~ParticleEmitter();
     void init();
-    void draw();
     void start();
     void stop();
     void setLifespan(const float life)   { lifespan = life; }
-    void setVelocity(const ofVec3f &vel) { velocity = vel; }
+    void setVelocity(const Vec3 &vel) { velocity = vel; }
     void setRate(const float r) { rate = r; }
     void setParticleRadius(const float r) { particleRadius = r; }
     void setEmitterType(EmitterType t) { type = t; }
     void setGroupSize(int s) { groupSize = s; }
     void setOneShot(bool s) { oneShot = s; }
     void setRandomLife(bool b) { randomLife = b;  }
-    void setLifespanRange(const ofVec2f &r) { lifeMinMax = r; }
+    void setLifespanRange(float min, float max) { lifeMinMax.set(min, max, 0); }
     void setMass(float m) { mass = m; }
     void setDamping(float d) { damping = d; }
     void update();
     void spawn(float time);
+    void spawnBatch(float time, int n);
     ParticleSystem *sys;
     float rate;         // per sec
     bool oneShot;
     bool fired;
     bool randomLife;
-    ofVec3f lifeMinMax;
-    ofVec3f velocity;
+    Vec3 lifeMinMax;
+    Vec3 velocity;
     float lifespan;     // sec
     float mass;
     float damping;
     bool started;
     float lastSpawned;  // ms
     float particleRadius;
-    ofColor particleColor;
+    Color particleColor;
     float radius;
     bool visible;
     int groupSize;      // number of particles to spawn in a group
     bool createdSys;
     EmitterType type;
+private:
+    void spawnDirectional(Particle *p, int n);
+    void spawnRadial(Particle *p, int n);
+    void spawnDisc(Particle *p, int n);
+    void spawnSphere(Particle *p, int n);
 };
@@ -0,0 +1,77 @@
+
+#include "ParticleGrid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+ParticleGrid::ParticleGrid() {
+    count = 0;
+    cellSize = 1;
+    invCellSize = 1;
+    tableMask = 0;
+}
+
+// rebin all particles.  cellSize should be about the typical query radius.
+//
+void ParticleGrid::build(const vector<Particle> &particles, float size) {
+    count = particles.size();
+    cellSize = size;
+    invCellSize = 1.0 / size;
+
+    // table of at least 2x the particle count, power of two so the hash can
+    // be masked.  arrays only grow, so steady state rebuilds never allocate.
+    //
+    unsigned tableSize = 1024;
+    while (tableSize < 2 * count) tableSize <<= 1;
+    tableMask = tableSize - 1;
+    if (cellStart.size() < tableSize + 1) cellStart.resize(tableSize + 1);
+    if (keys.size() < count) {
+        keys.resize(count);
+        slot.resize(count);
+        sortedIndices.resize(count);
+        sortedPositions.resize(count);
+    }
+    std::fill(cellStart.begin(), cellStart.begin() + tableSize + 1, 0);
+    if (count == 0) return;
+
+    ThreadPool &pool = ThreadPool::shared();
+
+    // 1) bucket of every particle (parallel)
+    //
+    pool.parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const Vec3 &p = particles[i].position;
+            keys[i] = hash(cellCoord(p.x), cellCoord(p.y), cellCoord(p.z));
+        }
+    });
+
+    // 2) count per bucket, remembering each particle's rank so the scatter
+    //    below is deterministic, then prefix sum into start offsets
+    //
+    for (int i = 0; i < count; i++)
+        slot[i] = cellStart[keys[i] + 1]++;
+    for (unsigned h = 0; h < tableSize; h++)
+        cellStart[h + 1] += cellStart[h];
+
+    // 3) scatter indices and positions into bucket order (parallel)
+    //
+    pool.parallelFor(count, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int k = cellStart[keys[i]] + slot[i];
+            sortedIndices[k] = i;
+            sortedPositions[k] = particles[i].position;
+        }
+    });
+}
+
+// collect the indices of all particles within radius of point
+//
+int ParticleGrid::query(const Vec3 &point, float radius, vector<int> &indicesRtn) const {
+    int found = 0;
+    forEachNear(point, radius, [&](int i) {
+        indicesRtn.push_back(i);
+        found++;
+    });
+    return found;
+}
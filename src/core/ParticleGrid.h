@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+#include "Particle.h"
+
+//  Uniform spatial hash grid over a particle array, rebuilt every frame.
+//
+//  build() bins particle indices by cell with a counting sort: cell keys
+//  and scatter run in parallel on the shared ThreadPool, and all arrays are
+//  kept between frames so a rebuild does not allocate once warmed up.
+//  Cells are hashed into a power of two table, so the grid is unbounded in
+//  space.  Queries visit only the cells overlapping the search sphere.
+//
+class ParticleGrid {
+public:
+    ParticleGrid();
+    void build(const std::vector<Particle> &particles, float cellSize);
+    int  query(const Vec3 &point, float radius, std::vector<int> &indicesRtn) const;
+
+    // call fn(index) for every particle within radius of point
+    //
+    template <class Fn>
+    void forEachNear(const Vec3 &point, float radius, Fn fn) const {
+        if (count == 0) return;
+        float r2 = radius * radius;
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; a++) {
+            lo[a] = cellCoord(point[a] - radius);
+            hi[a] = cellCoord(point[a] + radius);
+        }
+        for (int z = lo[2]; z <= hi[2]; z++)
+            for (int y = lo[1]; y <= hi[1]; y++)
+                for (int x = lo[0]; x <= hi[0]; x++) {
+                    unsigned h = hash(x, y, z);
+                    for (int k = cellStart[h]; k < cellStart[h + 1]; k++) {
+                        const Vec3 &q = sortedPositions[k];
+
+                        // skip entries of other cells sharing this bucket
+                        //
+                        if (cellCoord(q.x) != x || cellCoord(q.y) != y || cellCoord(q.z) != z)
+                            continue;
+                        if (q.squareDistance(point) <= r2)
+                            fn(sortedIndices[k]);
+                    }
+                }
+    }
+
+    // call fn(i, j) once for every pair of particles closer than radius
+    //
+    template <class Fn>
+    void forEachPair(float radius, Fn fn) const {
+        for (int k = 0; k < count; k++) {
+            int i = sortedIndices[k];
+            forEachNear(sortedPositions[k], radius, [&](int j) {
+                if (i < j) fn(i, j);
+            });
+        }
+    }
+
+    int cellCoord(float v) const { return (int)floorf(v * invCellSize); }
+    unsigned hash(int x, int y, int z) const {
+        return ((unsigned)x * 73856093u ^ (unsigned)y * 19349663u ^ (unsigned)z * 83492791u) & tableMask;
+    }
+
+    int count;              // particles in the grid
+    float cellSize;
+
+private:
+    float invCellSize;
+    unsigned tableMask;
+    std::vector<int> cellStart;      // tableSize + 1 offsets into sorted arrays
+    std::vector<int> keys;           // bucket of each particle
+    std::vector<int> slot;           // rank of each particle within its bucket
+    std::vector<int> sortedIndices;  // particle indices grouped by bucket
+    std::vector<Vec3> sortedPositions;
+};
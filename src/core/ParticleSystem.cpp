@@ -0,0 +1,271 @@
+
+// Kevin M.Smith - CS 134 SJSU
+
+#include "ParticleSystem.h"
+#include "TerrainCollider.h"
+#include "Profiler.h"
+#include <math.h>
+#include <limits.h>
+
+using namespace std;
+
+ParticleSystem::ParticleSystem(int capacity) {
+    setCapacity(capacity);
+}
+
+// set the maximum number of live particles.  storage for the whole pool
+// is reserved here so that spawning never reallocates the vector.  0
+// removes the cap and the vector grows as needed.
+//
+void ParticleSystem::setCapacity(int n) {
+    capacity = max(n, 0);
+    if (capacity == 0) return;
+    particles.reserve(capacity);
+    if (particles.size() > capacity)
+        particles.resize(capacity);
+}
+
+// live particles allowed right now
+//
+int ParticleSystem::limit() const {
+    if (capacity == 0) return INT_MAX;
+    return budget ? budget->cap(capacity) : capacity;
+}
+
+// grow the live range by up to n slots from the pool and return the index
+// of the first new slot.  the caller is expected to fill in every field of
+// the new particles; slots past a set capacity are dropped, so the number
+// actually granted is particles.size() - (returned index).
+//
+int ParticleSystem::allocate(int n) {
+    int first = particles.size();
+    int count = min(n, limit() - first);
+    if (count > 0) {
+        particles.resize(first + count);
+        for (int i = first; i < first + count; i++)
+            particles[i].serial = nextSerial++;
+        gridDirty = true;
+    }
+    return first;
+}
+
+// streams for a force set start here, clear of the runtime forces
+//
+static const int ForceSetStream = 256;
+
+// reseed the system and every force attached to it.  Each force gets its
+// own stream of the same key, so results only depend on the seed.
+//
+void ParticleSystem::setSeed(uint64_t seed) {
+    random.seed(seed);
+    for (int i = 0; i < forces.size(); i++)
+        forces[i]->random = random.stream(i + 1);
+    if (forceSet) forceSet->seed(random, ForceSetStream);
+}
+
+void ParticleSystem::add(const Particle &p) {
+    if (particles.size() >= limit()) return;
+    particles.push_back(p);
+    particles.back().serial = nextSerial++;
+    gridDirty = true;
+}
+
+void ParticleSystem::addForce(ParticleForce *f) {
+    f->random = random.stream(forces.size() + 1);
+    forces.push_back(f);
+}
+
+// use a compile time composed set of forces (see ForceSet.h).  It is
+// applied before the runtime list, which keeps working as before.
+//
+void ParticleSystem::setForces(ParticleForceSet *set) {
+    forceSet = set;
+    if (forceSet) forceSet->seed(random, ForceSetStream);
+}
+
+void ParticleSystem::remove(int i) {
+    particles.erase(particles.begin() + i);
+    gridDirty = true;
+}
+
+void ParticleSystem::setLifespan(float l) {
+    for (int i = 0; i < particles.size(); i++) {
+        particles[i].lifespan = l;
+    }
+}
+
+void ParticleSystem::reset() {
+    for (int i = 0; i < forces.size(); i++) {
+        forces[i]->applied = false;
+    }
+}
+
+void ParticleSystem::update() {
+    PROFILE_SCOPE("ParticleSystem::update");
+    // check if empty and just return
+    contacts = 0;
+    gridDirty = true;
+    if (particles.size() == 0) return;
+
+    // current time and step size both come from the system's clock
+    //
+    Clock *c = getClock();
+    float now = c->elapsedMillis();
+    float framerate = c->frameRate();
+
+    // check which particles have exceed their lifespan and delete
+    // from list.  Survivors are compacted toward the front in a single
+    // pass (keeping their order) so the pool never shifts per particle.
+    //
+    int live = 0;
+    for (int i = 0; i < particles.size(); i++) {
+        Particle &p = particles[i];
+        if (p.lifespan != -1 && p.age(now) > p.lifespan) continue;
+        if (i != live) particles[live] = p;
+        live++;
+    }
+    particles.resize(live);
+
+    // under load, particles far from the focus only get forces and a full
+    // step every few frames (staggered by spawn serial, which unlike the
+    // index does not shift as particles die); in between they coast along
+    // their last velocity.
+    //
+    int slices = budget ? budget->slices() : 1;
+    bool sliced = slices > 1 && lodDistance > 0;
+    if (sliced) {
+        float lod2 = lodDistance * lodDistance;
+        coasting.assign(particles.size(), 0);
+        for (int i = 0; i < particles.size(); i++) {
+            if ((particles[i].serial + frameCount) % slices != 0 &&
+                particles[i].position.squareDistance(focus) > lod2)
+                coasting[i] = 1;
+        }
+    }
+    frameCount++;
+
+    // update forces on all particles first, the static set in one fused
+    // pass, then anything in the runtime list
+    //
+    if (forceSet && particles.size() > 0)
+        forceSet->apply(&particles[0], particles.size(), sliced ? &coasting[0] : NULL);
+    for (int i = 0; i < particles.size(); i++) {
+        if (sliced && coasting[i]) continue;
+        for (int k = 0; k < forces.size(); k++) {
+            if (!forces[k]->applied)
+                forces[k]->updateForce( &particles[i] );
+        }
+    }
+
+    // update all forces only applied once to "applied"
+    // so they are not applied again.
+    //
+    for (int i = 0; i < forces.size(); i++) {
+        if (forces[i]->applyOnce)
+            forces[i]->applied = true;
+    }
+
+    // integrate all the particles in the store
+    // (check for 0 framerate to avoid divide errors)
+    //
+    if (framerate >= 1.0) {
+        float dt = 1.0 / framerate;
+        if (!sliced) {
+            for (int i = 0; i < particles.size(); i++)
+                integrator.step(particles[i], dt);
+        }
+        else {
+            float lod2 = lodDistance * lodDistance;
+            for (int i = 0; i < particles.size(); i++) {
+                Particle &p = particles[i];
+                if (coasting[i]) {
+                    p.position += p.velocity * dt;
+                    continue;
+                }
+
+                // a far particle's step covers the frames it coasted, so
+                // scale its forces and damping to match
+                //
+                if (p.position.squareDistance(focus) > lod2) {
+                    p.forces *= slices;
+                    integrator.step(p, dt);
+                    p.velocity *= integrator.decay(p, dt, slices - 1);
+                }
+                else integrator.step(p, dt);
+            }
+        }
+    }
+
+    // resolve terrain contacts for the whole cloud at once
+    //
+    if (terrain) contacts = terrain->collide(particles);
+
+    // bin the final positions for neighbor queries this frame
+    //
+    if (gridCellSize > 0) {
+        grid.build(particles, gridCellSize);
+        gridDirty = false;
+    }
+
+}
+
+// remove all particlies within "dist" of point, return number removed.
+// uses the grid when it is current, otherwise checks every particle.
+//
+int ParticleSystem::removeNear(const Vec3 & point, float dist) {
+    int n = particles.size();
+    if (n == 0) return 0;
+    removed.assign(n, 0);
+    int count = 0;
+    if (gridCellSize > 0 && !gridDirty) {
+        grid.forEachNear(point, dist, [&](int i) {
+            removed[i] = 1;
+            count++;
+        });
+    }
+    else {
+        float d2 = dist * dist;
+        for (int i = 0; i < n; i++) {
+            if (particles[i].position.squareDistance(point) <= d2) {
+                removed[i] = 1;
+                count++;
+            }
+        }
+    }
+    if (count == 0) return 0;
+
+    int live = 0;
+    for (int i = 0; i < n; i++) {
+        if (removed[i]) continue;
+        if (i != live) particles[live] = particles[i];
+        live++;
+    }
+    particles.resize(live);
+    gridDirty = true;
+    return count;
+}
+
+// Gravity Force Field
+//
+GravityForce::GravityForce(const Vec3 &g) {
+    gravity = g;
+}
+
+// Turbulence Force Field
+//
+TurbulenceForce::TurbulenceForce(const Vec3 &min, const Vec3 &max) {
+    tmin = min;
+    tmax = max;
+}
+
+// Impulse Radial Force - this is a "one shot" force that
+// eminates radially outward in random directions.
+//
+ImpulseRadialForce::ImpulseRadialForce(float magnitude) {
+    this->magnitude = magnitude;
+    applyOnce = true;
+}
+
+CyclicForce::CyclicForce(float magnitude) {
+    this->magnitude = magnitude;
+}
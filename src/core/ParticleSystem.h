@@ -0,0 +1,161 @@
+#pragma once
+//  Kevin M. Smith - CS 134 SJSU
+
+#include <vector>
+#include <stdint.h>
+#include "Vec3.h"
+#include "Clock.h"
+#include "Particle.h"
+#include "Random.h"
+#include "ParticleGrid.h"
+#include "ParticleBudget.h"
+#include "ForceSet.h"
+#include "Integrator.h"
+
+class TerrainCollider;
+
+
+//  Pure Virtual Function Class - must be subclassed to create new forces.
+//
+class ParticleForce {
+protected:
+public:
+    bool applyOnce = false;
+    bool applied = false;
+    SquaresRandom random;   // private stream, assigned by ParticleSystem::addForce()
+    virtual void updateForce(Particle *) = 0;
+};
+
+class ParticleSystem {
+public:
+    ParticleSystem(int capacity = 0);
+    void setCapacity(int);
+    void setSeed(uint64_t);
+    int  allocate(int n);
+    void add(const Particle &);
+    void addForce(ParticleForce *);
+    void setForces(ParticleForceSet *);
+    void remove(int);
+    void update();
+    void setLifespan(float);
+    void reset();
+    int removeNear(const Vec3 & point, float dist);
+    Clock *getClock() { return clock ? clock : Clock::getDefault(); }
+    std::vector<Particle> particles;
+    std::vector<ParticleForce *> forces;    // runtime list, not owned
+    ParticleForceSet *forceSet = NULL;      // static pipeline, not owned
+    Integrator integrator;              // how particles are stepped each frame
+    int capacity;       // max live particles, storage is reserved up front;
+                        // 0 grows without limit (and without a budget cap)
+    SquaresRandom random;   // stream 0 of this system, used for emission
+    Clock *clock = NULL;                // NULL uses Clock::getDefault()
+    TerrainCollider *terrain = NULL;    // optional ground to collide with
+    int contacts = 0;                   // particles touching terrain last update
+    ParticleGrid grid;                  // neighbor lookup, rebuilt each update
+    float gridCellSize = 0;             // 0 disables the grid
+    bool gridDirty = true;              // particles changed since grid was built
+    ParticleBudget *budget = NULL;      // optional, caps and time slices under load
+    Vec3 focus;                         // viewer position for the budget
+    float lodDistance = 0;              // particles farther than this from focus
+                                        // may be time sliced, 0 never slices
+private:
+    int limit() const;
+    std::vector<char> removed;               // scratch flags for removeNear()
+    std::vector<char> coasting;              // scratch flags for update()
+    unsigned frameCount = 0;
+    unsigned nextSerial = 0;                 // for Particle::serial
+};
+
+
+
+// Some convenient built-in forces
+//
+class GravityForce: public ParticleForce {
+    Vec3 gravity;
+public:
+    void set(const Vec3 &g) { gravity = g; }
+    GravityForce(const Vec3 & gravity);
+    GravityForce() { gravity.set(0, -10, 0); }
+    void updateForce(Particle *particle) {
+        // f = mg
+        particle->forces += gravity * particle->mass;
+    }
+};
+
+class TurbulenceForce : public ParticleForce {
+    Vec3 tmin, tmax;
+public:
+    void set(const Vec3 &min, const Vec3 &max) { tmin = min; tmax = max; }
+    TurbulenceForce(const Vec3 & min, const Vec3 &max);
+    TurbulenceForce() { tmin.set(0, 0, 0); tmax.set(0, 0, 0); }
+
+    // We are going to add a little "noise" to a particles
+    // forces to achieve a more natual look to the motion
+    //
+    void updateForce(Particle *particle) {
+        particle->forces.x += random.uniform(tmin.x, tmax.x);
+        particle->forces.y += random.uniform(tmin.y, tmax.y);
+        particle->forces.z += random.uniform(tmin.z, tmax.z);
+    }
+};
+
+class ImpulseRadialForce : public ParticleForce {
+    float magnitude = 1.0;
+    float height = .2;
+public:
+    void set(float mag) { magnitude = mag; }
+    void setHeight(float h) { height = h; }
+    ImpulseRadialForce(float magnitude);
+    ImpulseRadialForce() {}
+
+    // we basically create a random direction for each particle
+    // the force is only added once after it is triggered.
+    //
+    void updateForce(Particle *particle) {
+        Vec3 dir = Vec3(random.uniform(-1, 1), random.uniform(-height/2.0, height/2.0), random.uniform(-1, 1));
+        particle->forces += dir.getNormalized() * magnitude;
+    }
+};
+
+class CyclicForce : public ParticleForce {
+    float magnitude = 1.0;
+public:
+    void set(float mag) { magnitude = mag; }
+    CyclicForce(float magnitude);
+    CyclicForce() {}
+    void updateForce(Particle *particle) {
+        Vec3 norm = particle->position.getNormalized();
+        Vec3 dir = norm.cross(Vec3(0, 1, 0));
+        particle->forces += dir.getNormalized() * magnitude;
+    }
+};
+
+class ThrusterForce : public ParticleForce {
+    Vec3 thrust = Vec3(0, 0, 0);
+public:
+    void set(Vec3 t) { thrust = t; }
+    void add(Vec3 t) { thrust += t;  }
+    Vec3 get() const { return thrust; }
+    ThrusterForce(Vec3 t) { thrust = t; }
+    ThrusterForce() {}
+    void updateForce(Particle *particle) { particle->forces += thrust; }
+};
+
+class ImpulseForce : public ParticleForce {
+public:
+    ImpulseForce() {
+        applyOnce = true;
+        applied = true;
+        force = Vec3(0, 0, 0);
+    }
+    void apply(const Vec3 f) {
+        applied = false;
+        force = f;
+    }
+    void updateForce(Particle *particle) {
+        particle->forces += force;
+    }
+    
+    Vec3 force;
+};
+
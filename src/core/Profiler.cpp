@@ -0,0 +1,165 @@
+#include "Profiler.h"
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+typedef chrono::steady_clock ProfileTimer;
+
+// events a thread holds between collect() calls; past this (profiling on
+// but nobody collecting) new events are dropped
+//
+static const int MaxPending = 1 << 16;
+
+atomic<bool> Profiler::enabled(false);
+
+Profiler::Profiler() {
+    traceNext = 0;
+    traceWrapped = false;
+    epoch = chrono::duration_cast<chrono::nanoseconds>(ProfileTimer::now().time_since_epoch()).count();
+}
+
+Profiler &Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::now() const {
+    return chrono::duration_cast<chrono::nanoseconds>(ProfileTimer::now().time_since_epoch()).count() - epoch;
+}
+
+void Profiler::setEnabled(bool b) {
+    enabled = b;
+}
+
+// the calling thread's track, made on its first scope.  tracks live as
+// long as the profiler so events from finished threads stay valid.
+//
+Profiler::Track *Profiler::track() {
+    static thread_local Track *t = NULL;
+    if (t == NULL) {
+        lock_guard<std::mutex> lock(mutex);
+        t = new Track;
+        t->id = tracks.size();
+        t->depth = 0;
+        t->name = "thread " + to_string(t->id);
+        tracks.push_back(t);
+    }
+    return t;
+}
+
+void Profiler::setThreadName(const char *name) {
+    Track *t = track();
+    lock_guard<std::mutex> lock(t->mutex);
+    t->name = name;
+}
+
+void ProfileScope::end() {
+    Profiler &profiler = Profiler::get();
+    ProfileEvent e;
+    e.name = name;
+    e.start = start;
+    e.duration = (uint32_t)min<uint64_t>(profiler.now() - start, UINT32_MAX);
+    e.thread = track->id;
+    e.depth = depth;
+    track->depth--;
+    lock_guard<std::mutex> lock(track->mutex);
+    if (track->events.size() < MaxPending) track->events.push_back(e);
+}
+
+// gather every thread's events since the last call into the per scope
+// windows and the trace ring
+//
+void Profiler::collect() {
+    lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < samples.size(); i++) samples[i].calls = 0;
+    vector<ProfileEvent> events;
+    for (int t = 0; t < tracks.size(); t++) {
+        {
+            lock_guard<std::mutex> trackLock(tracks[t]->mutex);
+            events.swap(tracks[t]->events);
+        }
+        for (int i = 0; i < events.size(); i++) {
+            const ProfileEvent &e = events[i];
+            if (trace.size() < TraceCapacity) trace.push_back(e);
+            else {
+                trace[traceNext] = e;
+                traceNext = (traceNext + 1) % TraceCapacity;
+                traceWrapped = true;
+            }
+
+            int s = 0;
+            while (s < samples.size() && samples[s].name != e.name) s++;
+            if (s == samples.size()) {
+                Samples added;
+                added.name = e.name;
+                added.depth = e.depth;
+                added.calls = 0;
+                added.next = 0;
+                samples.push_back(added);
+            }
+            Samples &scope = samples[s];
+            float ms = e.duration / 1e6f;
+            if (scope.millis.size() < Window) scope.millis.push_back(ms);
+            else scope.millis[scope.next] = ms;
+            scope.next = (scope.next + 1) % Window;
+            scope.calls++;
+        }
+        events.clear();
+    }
+}
+
+static float percentile(const vector<float> &sorted, float p) {
+    if (sorted.size() == 0) return 0;
+    int i = (int)(p * (sorted.size() - 1) + .5f);
+    return sorted[i];
+}
+
+// scopes in the order they were first seen
+//
+vector<ProfileStats> Profiler::summary() {
+    lock_guard<std::mutex> lock(mutex);
+    vector<ProfileStats> stats;
+    vector<float> sorted;
+    for (int i = 0; i < samples.size(); i++) {
+        sorted = samples[i].millis;
+        sort(sorted.begin(), sorted.end());
+        ProfileStats s;
+        s.name = samples[i].name;
+        s.depth = samples[i].depth;
+        s.calls = samples[i].calls;
+        s.p50 = percentile(sorted, .5f);
+        s.p95 = percentile(sorted, .95f);
+        s.p99 = percentile(sorted, .99f);
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+// Chrome trace event format: one complete ("X") event per scope, plus
+// thread name metadata so each track is labelled
+//
+bool Profiler::exportTrace(const string &path) {
+    lock_guard<std::mutex> lock(mutex);
+    ofstream out(path.c_str());
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (int t = 0; t < tracks.size(); t++) {
+        lock_guard<std::mutex> trackLock(tracks[t]->mutex);
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":\"" << tracks[t]->name << "\"}}";
+        out << (t + 1 < tracks.size() || trace.size() > 0 ? ",\n" : "\n");
+    }
+    out.setf(ios::fixed);
+    out.precision(3);
+    int first = traceWrapped ? traceNext : 0;
+    for (int i = 0; i < trace.size(); i++) {
+        const ProfileEvent &e = trace[(first + i) % trace.size()];
+        out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+            << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << e.duration / 1000.0 << "}";
+        out << (i + 1 < trace.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return out.good();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+//  Build with -DLANDER_PROFILE=0 to remove every PROFILE_SCOPE.  Compiled
+//  in, a scope costs one relaxed load while the profiler is switched off.
+//
+#ifndef LANDER_PROFILE
+#define LANDER_PROFILE 1
+#endif
+
+//  One timed scope on one thread.
+//
+class ProfileEvent {
+public:
+    const char *name;       // string literal, compared by pointer
+    uint64_t start;         // ns since the profiler was created
+    uint32_t duration;      // ns
+    uint16_t thread;
+    uint16_t depth;         // scopes open around it on its thread
+};
+
+//  Rolling timings of one scope name over its last Window calls, in ms.
+//
+class ProfileStats {
+public:
+    const char *name;
+    int depth;
+    int calls;              // in the last collect()
+    float p50, p95, p99;
+};
+
+//  Scoped frame profiler.  PROFILE_SCOPE("name") times the rest of the
+//  enclosing block on whatever thread runs it; scopes nest.  Each thread
+//  keeps its own event list (its track in the trace), so recording only
+//  takes that thread's uncontended lock.  Once a frame the main thread
+//  calls collect() to move the events into the rolling stats and the
+//  trace buffer; exportTrace() writes the buffer as Chrome trace JSON
+//  (chrome://tracing or ui.perfetto.dev).
+//
+class Profiler {
+public:
+    static const int Window = 256;          // samples kept per scope
+    static const int TraceCapacity = 1 << 18;
+
+    static Profiler &get();
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool b);
+    void setThreadName(const char *name);   // names the calling thread's track
+
+    void collect();
+    std::vector<ProfileStats> summary();
+    bool exportTrace(const std::string &path);
+    uint64_t now() const;                   // ns
+
+    // per thread event list, only touched by its thread and collect()
+    //
+    class Track {
+    public:
+        std::mutex mutex;
+        std::vector<ProfileEvent> events;
+        std::string name;
+        int id;
+        int depth;
+    };
+    Track *track();
+
+private:
+    Profiler();
+    class Samples {
+    public:
+        const char *name;
+        int depth;
+        int calls;
+        int next;
+        std::vector<float> millis;
+    };
+
+    static std::atomic<bool> enabled;
+    std::mutex mutex;                       // tracks, samples and trace
+    std::vector<Track *> tracks;
+    std::vector<Samples> samples;
+    std::vector<ProfileEvent> trace;        // ring once full
+    int traceNext;
+    bool traceWrapped;
+    uint64_t epoch;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(const char *name) {
+        if (!Profiler::isEnabled()) {
+            track = NULL;
+            return;
+        }
+        this->name = name;
+        track = Profiler::get().track();
+        depth = track->depth++;
+        start = Profiler::get().now();
+    }
+    ~ProfileScope() {
+        if (track) end();
+    }
+
+private:
+    void end();
+    const char *name;
+    Profiler::Track *track;
+    uint64_t start;
+    int depth;
+};
+
+#if LANDER_PROFILE
+#define PROFILE_CAT(a, b) a##b
+#define PROFILE_NAME(line) PROFILE_CAT(profileScope, line)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_NAME(__LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+//  Counter based random number generator (Widynski's "Squares" RNG).
+//
+//  Every value is a pure function of (counter, key), so there is no hidden
+//  global state like ofRandom()/rand().  A generator is just a key and a
+//  counter:  seeding picks the key, and independent streams (one per force,
+//  per thread or per SIMD lane) are carved out of the counter space by
+//  putting a stream id in the upper 32 bits.  Two runs with the same seed
+//  produce exactly the same numbers.
+//
+class SquaresRandom {
+public:
+    SquaresRandom(uint64_t seed = DefaultSeed, uint32_t streamId = 0) {
+        this->seed(seed, streamId);
+    }
+
+    static const uint64_t DefaultSeed = 0x2545F4914F6CDD1DULL;
+
+    // derive a key from an arbitrary seed (splitmix64 finalizer, forced odd
+    // so that counter * key never collapses) and restart at the beginning
+    // of the given stream.
+    //
+    void seed(uint64_t s, uint32_t streamId = 0) {
+        uint64_t z = s + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z = z ^ (z >> 31);
+        key = z | 1;
+        counter = (uint64_t)streamId << 32;
+    }
+
+    // independent generator sharing this key, for another thread / lane
+    //
+    SquaresRandom stream(uint32_t streamId) const {
+        SquaresRandom r = *this;
+        r.counter = (uint64_t)streamId << 32;
+        return r;
+    }
+
+    // the raw 4 round "squares" hash of a counter
+    //
+    static inline uint32_t hash(uint64_t ctr, uint64_t key) {
+        uint64_t x, y, z;
+        y = x = ctr * key;
+        z = y + key;
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        x = x * x + z; x = (x >> 32) | (x << 32);
+        x = x * x + y; x = (x >> 32) | (x << 32);
+        return (uint32_t)((x * x + z) >> 32);
+    }
+
+    // map 24 random bits to [0, 1)
+    //
+    static inline float toUnit(uint32_t h) {
+        return (h >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint32_t next() { return hash(counter++, key); }
+
+    // same range convention as ofRandom(min, max)
+    //
+    float uniform(float min, float max) {
+        return min + toUnit(next()) * (max - min);
+    }
+
+    // fill "out" with n uniform values.  Each element only depends on its
+    // own counter, so the loop has no carried state and vectorizes.
+    //
+    void fill(float *out, int n, float min, float max) {
+        float range = max - min;
+        uint64_t base = counter;
+        uint64_t k = key;
+        for (int i = 0; i < n; i++)
+            out[i] = min + toUnit(hash(base + i, k)) * range;
+        counter += n;
+    }
+
+    uint64_t key;
+    uint64_t counter;
+};
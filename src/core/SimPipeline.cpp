@@ -0,0 +1,140 @@
+
+#include "SimPipeline.h"
+#include "Profiler.h"
+
+LanderFrame::LanderFrame() {
+    fuel = altitudes = 0;
+    timeToImpact = -1;
+    collided = gameOver = false;
+    contacts = frame = 0;
+    budgetLevel = 1;
+    budgetMillis = 0;
+    budgetSlices = 1;
+}
+
+void LanderFrame::capture(LanderSim &sim) {
+    lander = sim.sys.particles;
+    exhaust.pack(sim.engine.sys->particles);
+    landerPosition = sim.lander().position;
+    fuel = sim.fuel;
+    altitudes = sim.altitudes;
+    timeToImpact = sim.altimeter.timeToImpact;
+    collided = sim.collided;
+    gameOver = sim.gameOver;
+    contacts = sim.engine.sys->contacts;
+    frame = sim.frame;
+    budgetLevel = sim.budget.level;
+    budgetMillis = sim.budget.averageMillis;
+    budgetSlices = sim.budget.slices();
+}
+
+SimPipeline::SimPipeline(LanderSim &s, SampledClock *c) : sim(s), clock(c) {
+    stepMillis = 0;
+    stepRate = 60;
+    stepFrameMillis = queuedFrameMillis = -1;
+    front = 0;
+    busy = false;
+    stepped = false;
+    quit = false;
+    bPipelined = false;
+    frames[0].capture(sim);
+    setPipelined(std::thread::hardware_concurrency() > 1);
+}
+
+SimPipeline::~SimPipeline() {
+    setPipelined(false);
+}
+
+void SimPipeline::setPipelined(bool b) {
+    if (b == bPipelined) return;
+    if (b) {
+        quit = false;
+        thread = std::thread(&SimPipeline::worker, this);
+    }
+    else {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this] { return !busy; });
+            quit = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+    bPipelined = b;
+}
+
+// frame boundary.  publish the step that was running during the last
+// frame, then start the next one into the other buffer, at the time the
+// caller sampled.
+//
+void SimPipeline::step(float elapsedMillis, float frameRate) {
+    PROFILE_SCOPE("SimPipeline::step");
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !busy; });
+    stepMillis = elapsedMillis;
+    stepRate = frameRate;
+    stepFrameMillis = queuedFrameMillis;
+    queuedFrameMillis = -1;
+    if (!bPipelined) {
+        lock.unlock();
+        prepare();
+        sim.update();
+        frames[front].capture(sim);
+        return;
+    }
+    if (stepped) front = 1 - front;
+    busy = true;
+    stepped = false;
+    lock.unlock();
+    wake.notify_one();
+}
+
+// queue the last frame's work time for the budget; it reaches the sim
+// with the next step, without waiting for the one in flight
+//
+void SimPipeline::frameTime(float millis) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queuedFrameMillis = millis;
+}
+
+// hand the step's inputs to the sim, on the thread that runs the step
+//
+void SimPipeline::prepare() {
+    if (clock) clock->set(stepMillis, stepRate);
+    if (stepFrameMillis >= 0) sim.budget.frame(stepFrameMillis);
+}
+
+void SimPipeline::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !busy; });
+}
+
+LanderSim &SimPipeline::acquire() {
+    if (bPipelined) wait();
+    return sim;
+}
+
+void SimPipeline::worker() {
+    Profiler::get().setThreadName("sim");
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return busy || quit; });
+            if (quit) return;
+        }
+
+        // front and the step inputs are only changed by step() while no
+        // step is in flight
+        //
+        prepare();
+        sim.update();
+        frames[1 - front].capture(sim);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy = false;
+            stepped = true;
+        }
+        done.notify_all();
+    }
+}
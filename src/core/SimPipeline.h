@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Vec3.h"
+#include "Particle.h"
+#include "ParticleBatch.h"
+#include "LanderSim.h"
+
+//  Everything the app draws or shows from one simulated frame.
+//
+class LanderFrame {
+public:
+    LanderFrame();
+    void capture(LanderSim &sim);
+
+    std::vector<Particle> lander;   // the lander's particle system
+    ParticleBatch exhaust;          // packed engine exhaust
+    Vec3 landerPosition;
+    float fuel;
+    float altitudes;
+    float timeToImpact;
+    bool collided;
+    bool gameOver;
+    int contacts;
+    int frame;
+    float budgetLevel;
+    float budgetMillis;
+    int budgetSlices;
+};
+
+//  Runs LanderSim one frame ahead of the renderer.
+//
+//  Two LanderFrames are kept.  While the app draws the front one, a worker
+//  thread steps the sim and captures the result into the back one.  step()
+//  is the frame boundary: it waits for the step in flight, swaps the
+//  buffers and starts the next step.  Drawing then overlaps simulation at
+//  the cost of one frame of latency.
+//
+//  The sim must only be touched through acquire(), which waits for the
+//  worker.  The sim then stays idle until the next step().  What the sim
+//  needs from the main thread each frame travels with the step instead:
+//  the timer sampled by the caller (set on the clock, if given, before
+//  the sim updates) and the work time of the last drawn frame, queued by
+//  frameTime() for the sim's particle budget.
+//
+class SimPipeline {
+public:
+    SimPipeline(LanderSim &sim, SampledClock *clock = NULL);
+    ~SimPipeline();
+
+    void setPipelined(bool b);      // false steps inline, in step()
+    bool isPipelined() const { return bPipelined; }
+    void step(float elapsedMillis, float frameRate);
+    void frameTime(float millis);
+    LanderSim &acquire();
+    const LanderFrame &current() const { return frames[front]; }
+
+private:
+    void wait();
+    void worker();
+    void prepare();
+
+    LanderSim &sim;
+    SampledClock *clock;
+    float stepMillis, stepRate;     // for the step in flight
+    float stepFrameMillis;          // budget sample for it, < 0 if none
+    float queuedFrameMillis;        // from frameTime(), for the next step
+    LanderFrame frames[2];
+    int front;
+    bool bPipelined;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    bool busy;              // a step is in flight
+    bool stepped;           // the back frame holds a finished step
+    bool quit;
+};
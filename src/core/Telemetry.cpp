@@ -0,0 +1,110 @@
+#include "Telemetry.h"
+#include <chrono>
+
+using namespace std;
+
+// capacity is rounded up to a power of two so indices wrap with a mask.
+// head and tail count up forever; their difference is the fill.
+//
+TelemetryRing::TelemetryRing(int capacity) : dropped(0), head(0), tail(0) {
+    uint32_t n = 1;
+    while (n < (uint32_t)capacity) n <<= 1;
+    slots.resize(n);
+    mask = n - 1;
+}
+
+bool TelemetryRing::push(const TelemetryRecord &r) {
+    uint32_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) >= slots.size()) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    slots[h & mask] = r;
+    head.store(h + 1, memory_order_release);
+    return true;
+}
+
+bool TelemetryRing::pop(TelemetryRecord &r) {
+    uint32_t t = tail.load(memory_order_relaxed);
+    if (t == head.load(memory_order_acquire)) return false;
+    r = slots[t & mask];
+    tail.store(t + 1, memory_order_release);
+    return true;
+}
+
+int TelemetryRing::size() const {
+    return (int)(head.load(memory_order_acquire) - tail.load(memory_order_acquire));
+}
+
+TelemetryWriter::TelemetryWriter() : written(0), ring(NULL), format(TelemetryCsv), running(false) {
+}
+
+TelemetryWriter::~TelemetryWriter() {
+    stop();
+}
+
+bool TelemetryWriter::start(TelemetryRing &r, const string &path, TelemetryFormat f) {
+    stop();
+    format = f;
+    out.open(path.c_str(), format == TelemetryBinary ? ios::out | ios::binary : ios::out);
+    if (!out) return false;
+    if (format == TelemetryBinary) {
+        out << "lander-telemetry 2 " << sizeof(TelemetryRecord) << "\n";
+    }
+    else {
+        out << "frame,millis,x,y,z,vx,vy,vz,altitude,timeToImpact,fuel,collided,gameOver,thrusting";
+#if LANDER_TELEMETRY >= TELEMETRY_DEBUG
+        out << ",touchX,touchY,touchZ,normalX,normalY,normalZ,depth,triangle";
+#endif
+        out << "\n";
+    }
+    ring = &r;
+    written = 0;
+    running = true;
+    thread = std::thread(&TelemetryWriter::run, this);
+    return true;
+}
+
+void TelemetryWriter::stop() {
+    if (!running.exchange(false)) return;
+    if (thread.joinable()) thread.join();
+    TelemetryRecord r;
+    while (ring->pop(r)) write(r);
+    out.close();
+}
+
+// drain in bursts, sleeping while the ring is empty.  the file is flushed
+// only when the writer idles, never from the sim thread.
+//
+void TelemetryWriter::run() {
+    TelemetryRecord r;
+    while (running.load()) {
+        bool any = false;
+        while (ring->pop(r)) {
+            write(r);
+            any = true;
+        }
+        if (any) out.flush();
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+}
+
+void TelemetryWriter::write(const TelemetryRecord &r) {
+    if (format == TelemetryBinary) {
+        out.write((const char *)&r, sizeof(r));
+    }
+    else {
+        out << r.frame << "," << r.millis << ","
+            << r.position.x << "," << r.position.y << "," << r.position.z << ","
+            << r.velocity.x << "," << r.velocity.y << "," << r.velocity.z << ","
+            << r.altitude << "," << r.timeToImpact << "," << r.fuel << ","
+            << (int)r.collided << "," << (int)r.gameOver << "," << (int)r.thrusting;
+#if LANDER_TELEMETRY >= TELEMETRY_DEBUG
+        out << "," << r.touchPoint.x << "," << r.touchPoint.y << "," << r.touchPoint.z << ","
+            << r.contactNormal.x << "," << r.contactNormal.y << "," << r.contactNormal.z << ","
+            << r.contactDepth << "," << r.triangle;
+#endif
+        out << "\n";
+    }
+    written++;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include "Vec3.h"
+
+//  Telemetry level compiled in: 0 removes all telemetry, 1 (TELEMETRY_FLIGHT)
+//  logs one flight record per sim frame, 2 (TELEMETRY_DEBUG) adds the
+//  terrain contact detail to each record.  Build with -DLANDER_TELEMETRY=n.
+//
+#define TELEMETRY_FLIGHT 1
+#define TELEMETRY_DEBUG 2
+#ifndef LANDER_TELEMETRY
+#define LANDER_TELEMETRY TELEMETRY_FLIGHT
+#endif
+
+//  One sim frame of flight data, fixed size so it can be copied through
+//  the ring and written to the binary log as is.
+//
+class TelemetryRecord {
+public:
+    uint32_t frame;
+    float millis;           // sim clock (the fuel timer unless on the fixed step)
+    Vec3 position;
+    Vec3 velocity;
+    float altitude;
+    float timeToImpact;     // -1 if not closing on the terrain
+    float fuel;
+    uint8_t collided;
+    uint8_t gameOver;
+    uint8_t thrusting;
+
+    // TELEMETRY_DEBUG only
+    //
+    Vec3 touchPoint;
+    Vec3 contactNormal;
+    float contactDepth;
+    int32_t triangle;
+};
+
+//  Single producer, single consumer ring of records.  push() and pop()
+//  never block or allocate: the producer (the sim, on whichever thread
+//  steps it) drops a record and counts it when the ring is full rather
+//  than wait for the writer.
+//
+class TelemetryRing {
+public:
+    TelemetryRing(int capacity = 4096);
+    bool push(const TelemetryRecord &);     // producer only
+    bool pop(TelemetryRecord &);            // consumer only
+    int size() const;
+    int capacity() const { return (int)slots.size(); }
+    std::atomic<int> dropped;
+
+private:
+    std::vector<TelemetryRecord> slots;
+    uint32_t mask;
+    alignas(64) std::atomic<uint32_t> head;     // next slot to write
+    alignas(64) std::atomic<uint32_t> tail;     // next slot to read
+};
+
+typedef enum { TelemetryCsv, TelemetryBinary } TelemetryFormat;
+
+//  Background thread that drains a ring to a file.  The binary format is
+//  the line "lander-telemetry 2 <sizeof(TelemetryRecord)>" followed by the
+//  raw records; CSV has a header row and drops the debug columns unless
+//  they are compiled in.
+//
+class TelemetryWriter {
+public:
+    TelemetryWriter();
+    ~TelemetryWriter();
+    bool start(TelemetryRing &ring, const std::string &path, TelemetryFormat format = TelemetryCsv);
+    void stop();            // writes whatever is left in the ring and closes
+    bool isRunning() const { return running.load(); }
+    std::atomic<int> written;
+
+private:
+    void run();
+    void write(const TelemetryRecord &);
+
+    TelemetryRing *ring;
+    TelemetryFormat format;
+    std::ofstream out;
+    std::thread thread;
+    std::atomic<bool> running;
+};
@@ -0,0 +1,191 @@
+#include "TerrainBake.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include "Profiler.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+using namespace std;
+
+TerrainBake::TerrainBake() {
+    rays = 16;
+    radiusCells = 16;
+    step = 2;
+    sun = Vec3(1, 1, 1).getNormalized();
+    ambient = .45;
+    diffuse = .65;
+    nx = nz = 0;
+    millis = 0;
+    gridKey = 0;
+}
+
+bool TerrainBake::bake(const Octree &terrain, const TerrainChunks &grid, const atomic<bool> *cancel) {
+    PROFILE_SCOPE("TerrainBake::bake");
+    typedef std::chrono::steady_clock Timer;
+    Timer::time_point start = Timer::now();
+    nx = grid.nx;
+    nz = grid.nz;
+    gridKey = key(grid);
+    ao.assign(nx * nz, 255);
+    sunVisible.assign(nx * nz, 255);
+    float radius = radiusCells * grid.cellSize;
+    float lift = grid.cellSize * .1f + 2 * terrain.maxDeviation;
+    float sunRange = (nx + nz) * grid.cellSize;
+    const float golden = 2.39996323f;       // golden angle, radians
+
+    // grid lines that get baked: every step-th and the last
+    //
+    int s = max(step, 1);
+    vector<int> is, js;
+    for (int i = 0; i < nx; i++)
+        if (i % s == 0 || i == nx - 1) is.push_back(i);
+    for (int j = 0; j < nz; j++)
+        if (j % s == 0 || j == nz - 1) js.push_back(j);
+
+    // its own pool: the shared one runs one job at a time, and the sim
+    // should not wait seconds for the bake while the terrain loads
+    //
+    ThreadPool pool;
+    pool.parallelFor(is.size() * js.size(), [&](int begin, int end) {
+        RayHit hit;
+        for (int k = begin; k < end; k++) {
+            if (cancel && cancel->load(memory_order_relaxed)) return;
+            int i = is[k % is.size()], j = js[k / is.size()];
+            int g = j * nx + i;
+            if (!grid.isCovered(i, j)) continue;
+            Vec3 n = grid.normal(i, j);
+            Vec3 p = Vec3(grid.x0 + i * grid.cellSize, grid.height(i, j), grid.z0 + j * grid.cellSize) + n * lift;
+
+            // tangent frame around n; the spiral of samples is turned by a
+            // per point angle so neighbors don't share the same gaps
+            //
+            Vec3 t = fabs(n.x) < .9f ? Vec3(1, 0, 0).cross(n).getNormalized() : Vec3(0, 0, 1).cross(n).getNormalized();
+            Vec3 b = n.cross(t);
+            float turn = SquaresRandom::hash(g, SquaresRandom::DefaultSeed) * (2 * M_PI / 4294967296.0);
+            int open = 0;
+            for (int m = 0; m < rays; m++) {
+                float u = (m + .5f) / rays;
+                float r = sqrtf(u), phi = golden * m + turn;
+                Vec3 d = t * (r * cosf(phi)) + b * (r * sinf(phi)) + n * sqrtf(1 - u);
+                if (!terrain.raycast(p, d, radius, hit)) open++;
+            }
+            ao[g] = (unsigned char)(255 * open / max(rays, 1));
+            if (n.dot(sun) <= 0 || terrain.raycast(p, sun, sunRange, hit)) sunVisible[g] = 0;
+        }
+    }, 64);
+    if (cancel && cancel->load()) {
+        ao.clear();
+        sunVisible.clear();
+        return false;
+    }
+
+    // bilinear fill between the baked lines
+    //
+    if (s > 1) {
+        for (int j = 0; j < nz; j++) {
+            int j0 = j / s * s, j1 = min(j0 + s, nz - 1);
+            float fj = j1 > j0 ? (j - j0) / (float)(j1 - j0) : 0;
+            for (int i = 0; i < nx; i++) {
+                if ((i % s == 0 || i == nx - 1) && (j % s == 0 || j == nz - 1)) continue;
+                int i0 = i / s * s, i1 = min(i0 + s, nx - 1);
+                float fi = i1 > i0 ? (i - i0) / (float)(i1 - i0) : 0;
+                int a = j0 * nx + i0, b = j0 * nx + i1, c = j1 * nx + i0, d = j1 * nx + i1;
+                float w[4] = { (1 - fi) * (1 - fj), fi * (1 - fj), (1 - fi) * fj, fi * fj };
+                ao[j * nx + i] = (unsigned char)(w[0] * ao[a] + w[1] * ao[b] + w[2] * ao[c] + w[3] * ao[d] + .5f);
+                sunVisible[j * nx + i] = (unsigned char)(w[0] * sunVisible[a] + w[1] * sunVisible[b] +
+                                                         w[2] * sunVisible[c] + w[3] * sunVisible[d] + .5f);
+            }
+        }
+    }
+    millis = std::chrono::duration<double, std::milli>(Timer::now() - start).count();
+    return true;
+}
+
+// FNV-1a over the grid and the settings that change the result
+//
+uint64_t TerrainBake::key(const TerrainChunks &grid) const {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](const void *data, int size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for (int i = 0; i < size; i++) h = (h ^ bytes[i]) * 0x100000001b3ULL;
+    };
+    float settings[] = { (float)rays, radiusCells, (float)step, sun.x, sun.y, sun.z, grid.cellSize, grid.x0, grid.z0 };
+    mix(settings, sizeof(settings));
+    for (int j = 0; j < grid.nz; j++) {
+        for (int i = 0; i < grid.nx; i++) {
+            float y = grid.height(i, j);
+            mix(&y, sizeof(y));
+        }
+    }
+    return h;
+}
+
+// the line "terrain-bake 1 <nx> <nz> <key>" followed by the occlusion
+// and then the sun visibility bytes, row by row
+//
+bool TerrainBake::save(const std::string &path) const {
+    if (!isReady()) return false;
+    ofstream out(path.c_str(), ios::out | ios::binary);
+    if (!out) return false;
+    out << "terrain-bake 1 " << nx << " " << nz << " " << gridKey << "\n";
+    out.write((const char *)&ao[0], ao.size());
+    out.write((const char *)&sunVisible[0], sunVisible.size());
+    return out.good();
+}
+
+bool TerrainBake::load(const std::string &path, const TerrainChunks &grid) {
+    ifstream in(path.c_str(), ios::in | ios::binary);
+    if (!in) return false;
+    string magic;
+    int version, w, h;
+    uint64_t k;
+    in >> magic >> version >> w >> h >> k;
+    if (!in || magic != "terrain-bake" || version != 1 || w != grid.nx || h != grid.nz) return false;
+    if (k != key(grid)) return false;
+    in.get();
+    vector<unsigned char> a(w * h), s(w * h);
+    in.read((char *)&a[0], a.size());
+    in.read((char *)&s[0], s.size());
+    if (!in) return false;
+    ao.swap(a);
+    sunVisible.swap(s);
+    nx = w;
+    nz = h;
+    gridKey = k;
+    millis = 0;
+    return true;
+}
+
+float TerrainBake::shade(int i, int j, const Vec3 &normal) const {
+    int g = j * nx + i;
+    float facing = max(0.0f, normal.dot(sun));
+    float open = ambient + diffuse * facing;
+    if (open <= 0) return 1;
+    float lit = ambient * ao[g] / 255 + diffuse * facing * sunVisible[g] / 255;
+    return min(lit / open, 1.0f);
+}
+
+// shade for every chunk vertex: the chunk's grid points, then its
+// lowered border copies (see TerrainChunks::borderPoints())
+//
+void TerrainBake::apply(TerrainChunks &grid) const {
+    if (!isReady() || grid.nx != nx || grid.nz != nz) return;
+    int n = grid.chunkCells + 1;
+    vector<int> border;
+    grid.borderPoints(border);
+    for (int cz = 0; cz < grid.chunksZ; cz++) {
+        for (int cx = 0; cx < grid.chunksX; cx++) {
+            TerrainChunk &chunk = grid.chunks[cz * grid.chunksX + cx];
+            int bi = cx * grid.chunkCells, bj = cz * grid.chunkCells;
+            chunk.shade.clear();
+            for (int j = 0; j < n; j++)
+                for (int i = 0; i < n; i++)
+                    chunk.shade.push_back(shade(bi + i, bj + j, chunk.normals[j * n + i]));
+            for (int k = 0; k < border.size(); k++)
+                chunk.shade.push_back(chunk.shade[border[k]]);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <atomic>
+#include "Vec3.h"
+#include "Octree.h"
+#include "TerrainChunks.h"
+
+//  Lighting baked offline for the chunked terrain: per grid point ambient
+//  occlusion and sun visibility, both 0 (blocked) to 255 (open).
+//
+//  bake() casts "rays" cosine weighted hemisphere rays of length radius
+//  around the normal of every step-th grid point, plus one ray toward the
+//  sun, through the terrain octree on all cores; the points in between
+//  are interpolated, as both factors change slowly.  The rays start a
+//  little above the surface, clear of the octree's deviation if it was
+//  built from a proxy.  The result is cached in a file next to the mesh; load()
+//  only accepts a cache whose key (a hash of the grid heights and the
+//  bake settings) matches, so an edited terrain is baked again.  apply()
+//  turns the factors into a shade per chunk vertex: the light reaching
+//  the point, ambient * ao + diffuse * n.sun * sun visibility, over what
+//  it would be with nothing in the way.  The renderer uploads it as vertex
+//  colors, which scale the scene's own lighting.  Setting cancel
+//  (optional) stops a bake early; it then returns false and the bake is
+//  left empty.
+//
+class TerrainBake {
+public:
+    TerrainBake();
+    bool bake(const Octree &terrain, const TerrainChunks &grid, const std::atomic<bool> *cancel = NULL);
+    bool load(const std::string &path, const TerrainChunks &grid);
+    bool save(const std::string &path) const;
+    void apply(TerrainChunks &grid) const;
+    bool isReady() const { return !ao.empty(); }
+    float shade(int i, int j, const Vec3 &normal) const;
+
+    int rays;                   // hemisphere rays per grid point
+    float radiusCells;          // occlusion ray length, in grid cells
+    int step;                   // grid points baked in each direction, the rest interpolated
+    Vec3 sun;                   // toward the sun, mesh space
+    float ambient, diffuse;     // weights of ao and sun visibility in shade()
+
+    std::vector<unsigned char> ao, sunVisible;
+    int nx, nz;
+    double millis;              // bake time, 0 if loaded from the cache
+    uint64_t gridKey;           // key of the grid it was baked for
+
+private:
+    uint64_t key(const TerrainChunks &grid) const;
+};
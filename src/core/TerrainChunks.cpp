@@ -0,0 +1,340 @@
+#include "TerrainChunks.h"
+#include "Profiler.h"
+#include "Triangle.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+void Frustum::set(const Vec3 &eye, const Vec3 &forward, const Vec3 &up, float fovY,
+                  float aspect, float nearDist, float farDist) {
+    Vec3 f = forward.getNormalized();
+    Vec3 r = f.cross(up).getNormalized();
+    Vec3 u = r.cross(f);
+    float halfV = tan(fovY * M_PI / 360);
+    float halfH = halfV * aspect;
+
+    // each side plane holds the eye and one edge of the view, normals in
+    //
+    normals[0] = f;
+    normals[1] = -f;
+    normals[2] = (f - r * halfH).cross(u).getNormalized();
+    normals[3] = u.cross(f + r * halfH).getNormalized();
+    normals[4] = r.cross(f - u * halfV).getNormalized();
+    normals[5] = (f + u * halfV).cross(r).getNormalized();
+    offsets[0] = -f.dot(eye + f * nearDist);
+    offsets[1] = farDist > nearDist ? f.dot(eye + f * farDist) : FLT_MAX;
+    for (int i = 2; i < 6; i++)
+        offsets[i] = -normals[i].dot(eye);
+}
+
+// false only if the box is entirely behind one plane (boxes near a corner
+// of the frustum can pass without overlapping it)
+//
+bool Frustum::overlaps(const Vec3 &min, const Vec3 &max) const {
+    for (int i = 0; i < 6; i++) {
+        const Vec3 &n = normals[i];
+        Vec3 p(n.x >= 0 ? max.x : min.x, n.y >= 0 ? max.y : min.y, n.z >= 0 ? max.z : min.z);
+        if (n.dot(p) + offsets[i] < 0) return false;
+    }
+    return true;
+}
+
+void TerrainView::set(const Vec3 &e, const Vec3 &forward, const Vec3 &up, float fovY,
+                      float aspect, float nearDist, float farDist, float viewportHeight) {
+    eye = e;
+    frustum.set(eye, forward, up, fovY, aspect, nearDist, farDist);
+    pixelsPerUnit = viewportHeight / (2 * tan(fovY * M_PI / 360));
+}
+
+TerrainChunks::TerrainChunks() {
+    chunksX = chunksZ = 0;
+    chunkCells = 32;
+    levels = 0;
+    nx = nz = 0;
+    x0 = z0 = 0;
+    cellSize = 0;
+}
+
+// "resolution" is the number of grid cells along the longer horizontal
+// side of the mesh; chunkCells must be a power of two
+//
+void TerrainChunks::create(const Mesh &mesh, int resolution, int cells) {
+    PROFILE_SCOPE("TerrainChunks::create");
+    chunks.clear();
+    if (mesh.getNumVertices() == 0) return;
+    chunkCells = cells;
+    levels = 1;
+    while ((1 << levels) <= chunkCells) levels++;
+
+    Vec3 lo = mesh.getVertex(0), hi = lo;
+    for (int i = 1; i < mesh.getNumVertices(); i++) {
+        const Vec3 &v = mesh.getVertex(i);
+        lo.x = std::min(lo.x, v.x); hi.x = std::max(hi.x, v.x);
+        lo.z = std::min(lo.z, v.z); hi.z = std::max(hi.z, v.z);
+    }
+    x0 = lo.x;
+    z0 = lo.z;
+    cellSize = std::max(hi.x - lo.x, hi.z - lo.z) / resolution;
+    if (cellSize <= 0) return;
+    chunksX = std::max(1, (int)ceil((hi.x - lo.x) / cellSize / chunkCells));
+    chunksZ = std::max(1, (int)ceil((hi.z - lo.z) / cellSize / chunkCells));
+    nx = chunksX * chunkCells + 1;
+    nz = chunksZ * chunkCells + 1;
+    rasterize(mesh);
+
+    // errors first: a chunk's skirt has to reach down past whatever level
+    // its neighbors may be drawn at.  each level's error against the grid
+    // is added to the grid's own error against the mesh, so the bound
+    // holds against the source however coarse the resolution
+    //
+    vector<float> resampling;
+    resampleErrors(mesh, resampling);
+    chunks.resize(chunksX * chunksZ);
+    for (int cz = 0; cz < chunksZ; cz++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            TerrainChunk &chunk = chunks[cz * chunksX + cx];
+            chunk.errors.assign(levels, 0);
+            for (int l = 1; l < levels; l++)
+                chunk.errors[l] = std::max(chunk.errors[l - 1], levelError(cx, cz, l));
+            for (int l = 0; l < levels; l++)
+                chunk.errors[l] += resampling[cz * chunksX + cx];
+        }
+    }
+    for (int cz = 0; cz < chunksZ; cz++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            float neighbor = 0;
+            if (cx > 0) neighbor = std::max(neighbor, chunks[cz * chunksX + cx - 1].errors.back());
+            if (cx < chunksX - 1) neighbor = std::max(neighbor, chunks[cz * chunksX + cx + 1].errors.back());
+            if (cz > 0) neighbor = std::max(neighbor, chunks[(cz - 1) * chunksX + cx].errors.back());
+            if (cz < chunksZ - 1) neighbor = std::max(neighbor, chunks[(cz + 1) * chunksX + cx].errors.back());
+            TerrainChunk &chunk = chunks[cz * chunksX + cx];
+            chunk.skirtDepth = chunk.errors.back() + neighbor + cellSize * .01f;
+            buildChunk(cx, cz, chunk);
+        }
+    }
+}
+
+// grid point heights from the highest triangle over each point.  points
+// no triangle covers take the average of filled neighbors, so normals and
+// errors near holes stay sensible, but are never drawn.
+//
+void TerrainChunks::rasterize(const Mesh &mesh) {
+    heights.assign(nx * nz, -FLT_MAX);
+    covered.assign(nx * nz, 0);
+    float inv = 1 / cellSize;
+    for (int f = 0; f < mesh.getNumFaces(); f++) {
+        const Vec3 &a = mesh.getFaceVertex(f, 0);
+        const Vec3 &b = mesh.getFaceVertex(f, 1);
+        const Vec3 &c = mesh.getFaceVertex(f, 2);
+        int i0 = std::max(0, (int)ceil((std::min(a.x, std::min(b.x, c.x)) - x0) * inv));
+        int i1 = std::min(nx - 1, (int)floor((std::max(a.x, std::max(b.x, c.x)) - x0) * inv));
+        int j0 = std::max(0, (int)ceil((std::min(a.z, std::min(b.z, c.z)) - z0) * inv));
+        int j1 = std::min(nz - 1, (int)floor((std::max(a.z, std::max(b.z, c.z)) - z0) * inv));
+        for (int j = j0; j <= j1; j++) {
+            for (int i = i0; i <= i1; i++) {
+                float h;
+                if (!heightOnTriangle(x0 + i * cellSize, z0 + j * cellSize, a, b, c, h)) continue;
+                int k = j * nx + i;
+                if (h > heights[k]) heights[k] = h;
+                covered[k] = 1;
+            }
+        }
+    }
+
+    bool holes = true;
+    for (int pass = 0; holes && pass < nx + nz; pass++) {
+        holes = false;
+        vector<float> filled = heights;
+        for (int j = 0; j < nz; j++) {
+            for (int i = 0; i < nx; i++) {
+                if (heights[j * nx + i] != -FLT_MAX) continue;
+                float sum = 0;
+                int n = 0;
+                if (i > 0 && heights[j * nx + i - 1] != -FLT_MAX) { sum += heights[j * nx + i - 1]; n++; }
+                if (i < nx - 1 && heights[j * nx + i + 1] != -FLT_MAX) { sum += heights[j * nx + i + 1]; n++; }
+                if (j > 0 && heights[(j - 1) * nx + i] != -FLT_MAX) { sum += heights[(j - 1) * nx + i]; n++; }
+                if (j < nz - 1 && heights[(j + 1) * nx + i] != -FLT_MAX) { sum += heights[(j + 1) * nx + i]; n++; }
+                if (n > 0) filled[j * nx + i] = sum / n;
+                else holes = true;
+            }
+        }
+        heights.swap(filled);
+    }
+}
+
+// largest difference between the full grid and the level's triangles
+// (same diagonal as buildChunk() uses) over the chunk's drawn points
+//
+float TerrainChunks::levelError(int cx, int cz, int level) const {
+    int s = 1 << level;
+    int bi = cx * chunkCells, bj = cz * chunkCells;
+    float worst = 0;
+    for (int j = 0; j < chunkCells; j += s) {
+        for (int i = 0; i < chunkCells; i += s) {
+            int ai = bi + i, aj = bj + j;
+            if (!covered[aj * nx + ai] || !covered[aj * nx + ai + s] ||
+                !covered[(aj + s) * nx + ai] || !covered[(aj + s) * nx + ai + s])
+                continue;
+            float ha = height(ai, aj), hb = height(ai + s, aj);
+            float hc = height(ai, aj + s), hd = height(ai + s, aj + s);
+            for (int v = 0; v <= s; v++) {
+                for (int u = 0; u <= s; u++) {
+                    float fu = (float)u / s, fv = (float)v / s;
+                    float h = fu + fv <= 1 ? ha + fu * (hb - ha) + fv * (hc - ha)
+                                           : hd + (1 - fu) * (hc - hd) + (1 - fv) * (hb - hd);
+                    worst = std::max(worst, (float)fabs(height(ai + u, aj + v) - h));
+                }
+            }
+        }
+    }
+    return worst;
+}
+
+// per chunk, the largest height difference between the mesh vertices and
+// the full grid's triangles under them.  grid points take their heights
+// from the mesh, so this is what the grid loses between its points: the
+// peaks and pits of a mesh finer than the grid.  vertices over cells that
+// aren't drawn are skipped.
+//
+void TerrainChunks::resampleErrors(const Mesh &mesh, vector<float> &errors) const {
+    errors.assign(chunksX * chunksZ, 0);
+    float inv = 1 / cellSize;
+    for (int k = 0; k < mesh.getNumVertices(); k++) {
+        const Vec3 &v = mesh.getVertex(k);
+        float x = (v.x - x0) * inv, z = (v.z - z0) * inv;
+        int i = std::min(nx - 2, std::max(0, (int)floor(x)));
+        int j = std::min(nz - 2, std::max(0, (int)floor(z)));
+        float fu = x - i, fv = z - j;
+        int a = j * nx + i, b = a + 1, c = a + nx, d = c + 1;
+        float h;
+        if (fu + fv <= 1) {
+            if (!covered[a] || !covered[b] || !covered[c]) continue;
+            h = heights[a] + fu * (heights[b] - heights[a]) + fv * (heights[c] - heights[a]);
+        } else {
+            if (!covered[b] || !covered[c] || !covered[d]) continue;
+            h = heights[d] + (1 - fu) * (heights[c] - heights[d]) + (1 - fv) * (heights[b] - heights[d]);
+        }
+        float &worst = errors[(j / chunkCells) * chunksX + i / chunkCells];
+        worst = std::max(worst, (float)fabs(v.y - h));
+    }
+}
+
+// grid normal from central differences
+//
+Vec3 TerrainChunks::normal(int i, int j) const {
+    float dx = height(std::min(i + 1, nx - 1), j) - height(std::max(i - 1, 0), j);
+    float dz = height(i, std::min(j + 1, nz - 1)) - height(i, std::max(j - 1, 0));
+    return Vec3(-dx, 2 * cellSize, -dz).getNormalized();
+}
+
+// chunk points (j * (chunkCells + 1) + i) on the chunk's border, in the
+// order their lowered copies follow the grid points in a chunk's vertices
+//
+void TerrainChunks::borderPoints(vector<int> &points) const {
+    int n = chunkCells + 1;
+    points.clear();
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            if (i == 0 || j == 0 || i == n - 1 || j == n - 1)
+                points.push_back(j * n + i);
+}
+
+void TerrainChunks::buildChunk(int cx, int cz, TerrainChunk &chunk) {
+    int n = chunkCells + 1;
+    int bi = cx * chunkCells, bj = cz * chunkCells;
+    chunk.vertices.clear();
+    chunk.normals.clear();
+    chunk.shade.clear();
+    chunk.min = Vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+    chunk.max = Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            int gi = bi + i, gj = bj + j;
+            Vec3 p(x0 + gi * cellSize, height(gi, gj), z0 + gj * cellSize);
+            chunk.vertices.push_back(p);
+            chunk.normals.push_back(normal(gi, gj));
+            chunk.min = Vec3(std::min(chunk.min.x, p.x), std::min(chunk.min.y, p.y), std::min(chunk.min.z, p.z));
+            chunk.max = Vec3(std::max(chunk.max.x, p.x), std::max(chunk.max.y, p.y), std::max(chunk.max.z, p.z));
+        }
+    }
+
+    // lowered copy of the border, indexed through skirt[]
+    //
+    vector<int> border, skirt(n * n, -1);
+    borderPoints(border);
+    for (int k = 0; k < border.size(); k++) {
+        skirt[border[k]] = chunk.vertices.size();
+        chunk.vertices.push_back(chunk.vertices[border[k]] - Vec3(0, chunk.skirtDepth, 0));
+        chunk.normals.push_back(chunk.normals[border[k]]);
+    }
+
+    chunk.indices.assign(levels, vector<unsigned int>());
+    for (int l = 0; l < levels; l++) {
+        int s = 1 << l;
+        vector<unsigned int> &tris = chunk.indices[l];
+        for (int j = 0; j < chunkCells; j += s) {
+            for (int i = 0; i < chunkCells; i += s) {
+                int a = j * n + i, b = a + s, c = a + s * n, d = c + s;
+                bool ca = covered[(bj + j) * nx + bi + i] != 0;
+                bool cb = covered[(bj + j) * nx + bi + i + s] != 0;
+                bool cc = covered[(bj + j + s) * nx + bi + i] != 0;
+                bool cd = covered[(bj + j + s) * nx + bi + i + s] != 0;
+                if (ca && cb && cc) {
+                    tris.push_back(a); tris.push_back(c); tris.push_back(b);
+                }
+                if (cb && cc && cd) {
+                    tris.push_back(b); tris.push_back(c); tris.push_back(d);
+                }
+            }
+        }
+
+        // skirt quads along the four edges at this level's spacing
+        //
+        for (int e = 0; e < 4; e++) {
+            for (int k = 0; k < chunkCells; k += s) {
+                int i0, j0, i1, j1;
+                switch (e) {
+                    case 0: i0 = k; j0 = 0; i1 = k + s; j1 = 0; break;
+                    case 1: i0 = k; j0 = chunkCells; i1 = k + s; j1 = chunkCells; break;
+                    case 2: i0 = 0; j0 = k; i1 = 0; j1 = k + s; break;
+                    default: i0 = chunkCells; j0 = k; i1 = chunkCells; j1 = k + s; break;
+                }
+                if (!covered[(bj + j0) * nx + bi + i0] || !covered[(bj + j1) * nx + bi + i1]) continue;
+                int p0 = j0 * n + i0, p1 = j1 * n + i1;
+                int s0 = skirt[p0], s1 = skirt[p1];
+                tris.push_back(p0); tris.push_back(p1); tris.push_back(s1);
+                tris.push_back(p0); tris.push_back(s1); tris.push_back(s0);
+            }
+        }
+    }
+}
+
+// projected error in pixels, measured to the nearest point of the chunk
+//
+float TerrainChunks::screenError(int c, int level, const TerrainView &view) const {
+    const TerrainChunk &chunk = chunks[c];
+    const Vec3 &e = view.eye;
+    float dx = std::max(0.0f, std::max(chunk.min.x - e.x, e.x - chunk.max.x));
+    float dy = std::max(0.0f, std::max(chunk.min.y - e.y, e.y - chunk.max.y));
+    float dz = std::max(0.0f, std::max(chunk.min.z - e.z, e.z - chunk.max.z));
+    float d = sqrt(dx * dx + dy * dy + dz * dz);
+    if (d < 1e-6) return chunk.errors[level] > 0 ? FLT_MAX : 0;
+    return chunk.errors[level] * view.pixelsPerUnit / d;
+}
+
+void TerrainChunks::select(const TerrainView &view, vector<ChunkDraw> &drawList) const {
+    PROFILE_SCOPE("TerrainChunks::select");
+    drawList.clear();
+    for (int c = 0; c < chunks.size(); c++) {
+        const TerrainChunk &chunk = chunks[c];
+        if (!view.frustum.overlaps(chunk.min - Vec3(0, chunk.skirtDepth, 0), chunk.max)) continue;
+        int level = levels - 1;
+        while (level > 0 && screenError(c, level, view) > view.tolerance) level--;
+        ChunkDraw draw;
+        draw.chunk = c;
+        draw.level = level;
+        drawList.push_back(draw);
+    }
+}
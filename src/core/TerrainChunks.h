@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+#include "Mesh.h"
+
+//  View frustum as six inward facing planes; a point p is inside plane i
+//  when normals[i].dot(p) + offsets[i] >= 0.  A far distance not beyond
+//  the near one (OF cameras default to 0) leaves the far plane out.
+//
+class Frustum {
+public:
+    void set(const Vec3 &eye, const Vec3 &forward, const Vec3 &up, float fovY,
+             float aspect, float nearDist, float farDist);
+    bool overlaps(const Vec3 &min, const Vec3 &max) const;
+    Vec3 normals[6];
+    float offsets[6];
+};
+
+//  Camera as the chunk selection sees it, in terrain mesh space.
+//  pixelsPerUnit is the viewport height over 2 tan(fovY / 2): an error of
+//  e at distance d covers e * pixelsPerUnit / d pixels on screen.
+//
+class TerrainView {
+public:
+    TerrainView() : pixelsPerUnit(1), tolerance(2) {}
+    void set(const Vec3 &eye, const Vec3 &forward, const Vec3 &up, float fovY,
+             float aspect, float nearDist, float farDist, float viewportHeight);
+    Vec3 eye;
+    Frustum frustum;
+    float pixelsPerUnit;
+    float tolerance;        // largest screen space error allowed, pixels
+};
+
+//  One square piece of the terrain grid with its own vertices and a
+//  triangle list per level of detail.  Level l samples every 2^l-th grid
+//  point; errors[l] bounds the height difference between the source mesh
+//  and level l over the chunk: level l against the full grid plus the
+//  full grid against the mesh vertices.  The vertices are the chunk's grid
+//  points followed by a copy of its border lowered by skirtDepth, in
+//  borderPoints() order: every level closes its border with a skirt down
+//  to that copy, which hides the cracks between neighbors drawn at
+//  different levels.
+//
+class TerrainChunk {
+public:
+    Vec3 min, max;                  // bounds of the surface (without skirts)
+    float skirtDepth;
+    std::vector<Vec3> vertices;
+    std::vector<Vec3> normals;
+    std::vector<float> shade;       // baked, per vertex, if any (see TerrainBake)
+    std::vector<float> errors;
+    std::vector<std::vector<unsigned int> > indices;
+};
+
+class ChunkDraw {
+public:
+    int chunk;
+    int level;
+};
+
+//  Chunked level of detail terrain built from the terrain mesh.
+//
+//  create() resamples the mesh onto a regular x-z height grid (grid point
+//  heights come from the triangles above them), cuts the grid into
+//  chunkCells x chunkCells chunks and precomputes every level of each.
+//  select() runs per frame on the CPU: chunks outside the frustum are
+//  dropped and each remaining chunk gets the coarsest level whose error,
+//  projected to the screen at the chunk's distance, stays within the
+//  view's tolerance.  Rendering (see TerrainRenderer) just draws the list.
+//
+class TerrainChunks {
+public:
+    TerrainChunks();
+    void create(const Mesh &mesh, int resolution = 512, int chunkCells = 32);
+    void select(const TerrainView &view, std::vector<ChunkDraw> &drawList) const;
+    float screenError(int chunk, int level, const TerrainView &view) const;
+    bool isReady() const { return !chunks.empty(); }
+    float height(int i, int j) const { return heights[j * nx + i]; }
+    bool isCovered(int i, int j) const { return covered[j * nx + i] != 0; }
+    Vec3 normal(int i, int j) const;
+    void borderPoints(std::vector<int> &points) const;
+
+    std::vector<TerrainChunk> chunks;
+    int chunksX, chunksZ;
+    int chunkCells;
+    int levels;
+    int nx, nz;                     // grid points
+    float x0, z0;                   // grid origin
+    float cellSize;
+
+private:
+    void rasterize(const Mesh &mesh);
+    void buildChunk(int cx, int cz, TerrainChunk &chunk);
+    float levelError(int cx, int cz, int level) const;
+    void resampleErrors(const Mesh &mesh, std::vector<float> &errors) const;
+    std::vector<float> heights;
+    std::vector<unsigned char> covered;     // grid point lies under a triangle
+};
@@ -0,0 +1,150 @@
+
+#include "TerrainCollider.h"
+#include "Profiler.h"
+#include <float.h>
+#include <algorithm>
+
+using namespace std;
+
+static float clamp(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+TerrainCollider::TerrainCollider() {
+    restitution = .3;
+    friction = .2;
+    offset = Vec3(0, 0, 0);
+    nx = nz = 0;
+    x0 = z0 = 0;
+    cellSize = invCellSize = 1;
+}
+
+// build the height grid from every point stored in the octree's leaves.
+// "resolution" is the number of cells along the longer horizontal side.
+//
+void TerrainCollider::create(const Octree &octree, int resolution) {
+    PROFILE_SCOPE("TerrainCollider::create");
+    Vec3 lo = octree.root.box.min(), hi = octree.root.box.max();
+    x0 = lo.x;
+    z0 = lo.z;
+    float w = hi.x - x0;
+    float d = hi.z - z0;
+    cellSize = max(w, d) / resolution;
+    if (cellSize <= 0) return;
+    invCellSize = 1.0 / cellSize;
+    nx = (int)(w * invCellSize) + 1;
+    nz = (int)(d * invCellSize) + 1;
+    heights.assign(nx * nz, -FLT_MAX);
+
+    // walk the tree without recursion, keeping the highest point per cell
+    //
+    vector<const TreeNode *> stack;
+    stack.push_back(&octree.root);
+    while (!stack.empty()) {
+        const TreeNode *node = stack.back();
+        stack.pop_back();
+        if (node->children.size() > 0) {
+            for (int i = 0; i < node->children.size(); i++)
+                stack.push_back(&node->children[i]);
+            continue;
+        }
+        for (int i = 0; i < node->points.size(); i++) {
+            Vec3 v = octree.mesh->getVertex(node->points[i]);
+            int ci = clamp((v.x - x0) * invCellSize, 0, nx - 1);
+            int cj = clamp((v.z - z0) * invCellSize, 0, nz - 1);
+            float &h = heights[cj * nx + ci];
+            if (v.y > h) h = v.y;
+        }
+    }
+
+    // fill cells that received no vertex from their filled neighbors
+    //
+    bool holes = true;
+    for (int pass = 0; holes && pass < resolution; pass++) {
+        holes = false;
+        vector<float> filled = heights;
+        for (int j = 0; j < nz; j++) {
+            for (int i = 0; i < nx; i++) {
+                if (heights[j * nx + i] != -FLT_MAX) continue;
+                float sum = 0;
+                int n = 0;
+                if (i > 0 && heights[j * nx + i - 1] != -FLT_MAX) { sum += heights[j * nx + i - 1]; n++; }
+                if (i < nx - 1 && heights[j * nx + i + 1] != -FLT_MAX) { sum += heights[j * nx + i + 1]; n++; }
+                if (j > 0 && heights[(j - 1) * nx + i] != -FLT_MAX) { sum += heights[(j - 1) * nx + i]; n++; }
+                if (j < nz - 1 && heights[(j + 1) * nx + i] != -FLT_MAX) { sum += heights[(j + 1) * nx + i]; n++; }
+                if (n > 0) filled[j * nx + i] = sum / n;
+                else holes = true;
+            }
+        }
+        heights.swap(filled);
+    }
+
+    // surface normals from central differences of the heights
+    //
+    normals.resize(nx * nz);
+    for (int j = 0; j < nz; j++) {
+        for (int i = 0; i < nx; i++) {
+            float dx = cellHeight(i + 1, j) - cellHeight(i - 1, j);
+            float dz = cellHeight(i, j + 1) - cellHeight(i, j - 1);
+            normals[j * nx + i] = Vec3(-dx, 2 * cellSize, -dz).getNormalized();
+        }
+    }
+}
+
+float TerrainCollider::cellHeight(int i, int j) const {
+    i = clamp(i, 0, nx - 1);
+    j = clamp(j, 0, nz - 1);
+    return heights[j * nx + i];
+}
+
+// bilinear terrain height at (x, z) in mesh space.  returns false outside
+// the grid or over cells that never received any terrain.
+//
+bool TerrainCollider::height(float x, float z, float &h) const {
+    float fx = (x - x0) * invCellSize;
+    float fz = (z - z0) * invCellSize;
+    if (fx < 0 || fz < 0 || fx > nx - 1 || fz > nz - 1) return false;
+    int i = fx;
+    int j = fz;
+    float tx = fx - i;
+    float tz = fz - j;
+    float h00 = cellHeight(i, j), h10 = cellHeight(i + 1, j);
+    float h01 = cellHeight(i, j + 1), h11 = cellHeight(i + 1, j + 1);
+    if (h00 == -FLT_MAX || h10 == -FLT_MAX || h01 == -FLT_MAX || h11 == -FLT_MAX)
+        return false;
+    h = (h00 * (1 - tx) + h10 * tx) * (1 - tz) + (h01 * (1 - tx) + h11 * tx) * tz;
+    return true;
+}
+
+Vec3 TerrainCollider::normal(float x, float z) const {
+    int i = clamp((x - x0) * invCellSize + .5, 0, nx - 1);
+    int j = clamp((z - z0) * invCellSize + .5, 0, nz - 1);
+    return normals[j * nx + i];
+}
+
+// collide every particle against the terrain in one pass.  particles below
+// the surface are pushed back onto it; the velocity component into the
+// surface is reflected (scaled by restitution) and the tangential component
+// is slowed by friction, so particles bounce on steep hits and slide on
+// glancing ones.  returns the number of particles in contact.
+//
+int TerrainCollider::collide(vector<Particle> &particles) {
+    if (!isReady()) return 0;
+    int contacts = 0;
+    for (int k = 0; k < particles.size(); k++) {
+        Particle &p = particles[k];
+        Vec3 q = p.position + offset;
+        float h;
+        if (!height(q.x, q.z, h) || q.y - p.radius > h) continue;
+        contacts++;
+        p.position.y += h - (q.y - p.radius);
+        Vec3 n = normal(q.x, q.z);
+        float vn = p.velocity.dot(n);
+        if (vn < 0) {
+            Vec3 normalVel = n * vn;
+            Vec3 tangentVel = p.velocity - normalVel;
+            p.velocity = tangentVel * (1 - friction) - normalVel * restitution;
+        }
+    }
+    return contacts;
+}
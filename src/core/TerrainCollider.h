@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "Vec3.h"
+#include "Octree.h"
+#include "Particle.h"
+
+//  Height field collision proxy for the terrain, used to collide large
+//  numbers of particles in bulk.
+//
+//  create() rasterizes the points indexed by a terrain Octree into a regular
+//  x-z grid of surface heights (plus normals from central differences), so
+//  each particle costs one constant time grid lookup instead of a recursive
+//  descent of the tree.  collide() tests and responds for a whole particle
+//  array in a single pass and returns the number of contacts.
+//
+class TerrainCollider {
+public:
+    TerrainCollider();
+    void create(const Octree &octree, int resolution = 256);
+    int  collide(std::vector<Particle> &particles);
+    bool height(float x, float z, float &h) const;
+    Vec3 normal(float x, float z) const;
+    bool isReady() const { return !heights.empty(); }
+
+    float restitution;  // fraction of normal velocity kept on bounce
+    float friction;     // fraction of tangential velocity lost on contact
+    Vec3 offset;     // added to particle positions to get to mesh space
+
+private:
+    float cellHeight(int i, int j) const;
+    std::vector<float> heights;
+    std::vector<Vec3> normals;
+    int nx, nz;
+    float x0, z0;       // grid origin (min corner of root box)
+    float cellSize, invCellSize;
+};
@@ -0,0 +1,90 @@
+#include "TerrainFile.h"
+#include "MappedFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const size_t HeaderSize = 128;
+static const uint32_t OrderMark = 0x01020304;
+
+// size and modification time of the file the mesh came from, 0 if none
+//
+static void sourceStamp(const string &source, long long &size, long long &time) {
+    size = time = 0;
+    struct stat st;
+    if (source.empty() || stat(source.c_str(), &st) != 0) return;
+    size = st.st_size;
+    time = st.st_mtime;
+}
+
+bool saveTerrainFile(const string &path, const Mesh &mesh, const string &source) {
+    long long size, time;
+    sourceStamp(source, size, time);
+    char header[HeaderSize];
+    memset(header, 0, HeaderSize);
+    snprintf(header, HeaderSize - sizeof(OrderMark), "terrain-mesh 1 %d %d %d %lld %lld\n",
+             (int)mesh.vertices.size(), (int)mesh.normals.size(), (int)mesh.indices.size(), size, time);
+    memcpy(header + HeaderSize - sizeof(OrderMark), &OrderMark, sizeof(OrderMark));
+
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (fp == NULL) return false;
+    bool ok = fwrite(header, 1, HeaderSize, fp) == HeaderSize;
+    if (ok && !mesh.vertices.empty())
+        ok = fwrite(&mesh.vertices[0], sizeof(Vec3), mesh.vertices.size(), fp) == mesh.vertices.size();
+    if (ok && !mesh.normals.empty())
+        ok = fwrite(&mesh.normals[0], sizeof(Vec3), mesh.normals.size(), fp) == mesh.normals.size();
+    if (ok && !mesh.indices.empty())
+        ok = fwrite(&mesh.indices[0], sizeof(unsigned int), mesh.indices.size(), fp) == mesh.indices.size();
+    if (fclose(fp) != 0) ok = false;
+    if (!ok) remove(path.c_str());
+    return ok;
+}
+
+bool loadTerrainFile(const string &path, Mesh &mesh, const string &source) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < HeaderSize) return false;
+    const unsigned char *p = file.data();
+
+    char text[HeaderSize + 1];
+    memcpy(text, p, HeaderSize);
+    text[HeaderSize] = 0;
+    char magic[16];
+    int version, nv, nn, ni;
+    long long size, time;
+    if (sscanf(text, "%15s %d %d %d %d %lld %lld", magic, &version, &nv, &nn, &ni, &size, &time) != 7)
+        return false;
+    uint32_t mark;
+    memcpy(&mark, p + HeaderSize - sizeof(mark), sizeof(mark));
+    if (strcmp(magic, "terrain-mesh") != 0 || version != 1 || mark != OrderMark) return false;
+    if (nv < 0 || ni < 0 || ni % 3 != 0 || (nn != 0 && nn != nv)) return false;
+    if (file.size() != HeaderSize + (size_t)(nv + nn) * sizeof(Vec3) + (size_t)ni * sizeof(unsigned int))
+        return false;
+    if (!source.empty()) {
+        long long sourceSize, sourceTime;
+        sourceStamp(source, sourceSize, sourceTime);
+        if (size != sourceSize || time != sourceTime) return false;
+    }
+
+    p += HeaderSize;
+    mesh.vertices.resize(nv);
+    mesh.normals.resize(nn);
+    mesh.indices.resize(ni);
+    if (nv > 0) memcpy(&mesh.vertices[0], p, nv * sizeof(Vec3));
+    p += nv * sizeof(Vec3);
+    if (nn > 0) memcpy(&mesh.normals[0], p, nn * sizeof(Vec3));
+    p += nn * sizeof(Vec3);
+    if (ni > 0) memcpy(&mesh.indices[0], p, ni * sizeof(unsigned int));
+
+    // the octree and chunks index the vertices without checking
+    //
+    for (int i = 0; i < ni; i++) {
+        if (mesh.indices[i] >= (unsigned int)nv) {
+            mesh = Mesh();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include "Mesh.h"
+
+//  Binary terrain mesh: the parsed OBJ saved so later starts load it
+//  without parsing.  The file is a HeaderSize byte header, the vertices
+//  (three floats each), the normals (none or one per vertex, likewise)
+//  and the indices (32 bit), in the byte order of the machine that wrote
+//  it.  The header holds a text line
+//
+//      terrain-mesh 1 <vertices> <normals> <indices> <source size> <source time>
+//
+//  and ends with an order mark; a file written on a machine of the other
+//  byte order is rejected.
+//
+//  loadTerrainFile() maps the file (see MappedFile) and copies the arrays
+//  straight into the mesh.  Given the source OBJ it only accepts a file
+//  saved from that OBJ as it is now (same size and modification time),
+//  which makes path + ".mesh" usable as a cache next to the OBJ; without
+//  one any valid file loads, so a converted terrain can ship on its own.
+//
+bool saveTerrainFile(const std::string &path, const Mesh &mesh, const std::string &source = "");
+bool loadTerrainFile(const std::string &path, Mesh &mesh, const std::string &source = "");
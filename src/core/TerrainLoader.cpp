@@ -0,0 +1,158 @@
+
+#include "TerrainLoader.h"
+#include "ObjLoader.h"
+#include "TerrainFile.h"
+#include "Profiler.h"
+#include "Triangle.h"
+#include <chrono>
+#include <algorithm>
+
+const float TerrainLoader::ProxyEdgeScale = 3;
+
+TerrainLoader::TerrainLoader() : stage(TerrainIdle), parsed(0), cancelled(false), chunksReady(false),
+    collisionReady(false) {
+    buildMillis = 0;
+    proxyStats = SimplifyStats();
+}
+
+TerrainLoader::~TerrainLoader() {
+    cancel();
+}
+
+void TerrainLoader::start(const std::string &path, Octree &octree, TerrainCollider &collider,
+                          int levels, int resolution, TerrainChunks *chunks, float proxyError,
+                          TerrainBake *bake) {
+    cancel();
+    cancelled = false;
+    chunksReady = collisionReady = false;
+    stage = TerrainParsing;
+    parsed = 0;
+    thread = std::thread(&TerrainLoader::load, this, path, &octree, &collider, levels, resolution, chunks,
+                         proxyError, bake);
+}
+
+void TerrainLoader::wait() {
+    if (thread.joinable()) thread.join();
+}
+
+void TerrainLoader::cancel() {
+    cancelled = true;
+    wait();
+}
+
+// a binary terrain file as is; an OBJ from its binary cache (path +
+// ".mesh") when that is up to date, otherwise parsed and cached
+//
+bool TerrainLoader::readMesh(const std::string &path, Mesh &mesh) {
+    const std::string binary = ".mesh";
+    if (path.size() > binary.size() && path.compare(path.size() - binary.size(), binary.size(), binary) == 0) {
+        PROFILE_SCOPE("loadTerrainFile");
+        return loadTerrainFile(path, mesh);
+    }
+    {
+        PROFILE_SCOPE("loadTerrainFile");
+        if (loadTerrainFile(path + binary, mesh, path)) return true;
+    }
+    PROFILE_SCOPE("loadObj");
+    if (!loadObj(path, mesh, &parsed, &cancelled)) return false;
+    saveTerrainFile(path + binary, mesh, path);
+    return true;
+}
+
+// end the job here if it was cancelled
+//
+bool TerrainLoader::stopped() {
+    if (!cancelled) return false;
+    stage = TerrainCancelled;
+    return true;
+}
+
+void TerrainLoader::load(std::string path, Octree *octree, TerrainCollider *collider, int levels, int resolution,
+                         TerrainChunks *chunks, float proxyError, TerrainBake *bake) {
+    typedef std::chrono::steady_clock Timer;
+    Timer::time_point start = Timer::now();
+    Profiler::get().setThreadName("terrain loader");
+    // the octree keeps the mesh it is built from, so load it into shared
+    // storage and hand it over rather than copying it
+    //
+    std::shared_ptr<Mesh> shared = std::make_shared<Mesh>();
+    const Mesh &mesh = *shared;
+    if (!readMesh(path, *shared)) {
+        stage = cancelled ? TerrainCancelled : TerrainFailed;
+        return;
+    }
+    if (stopped()) return;
+    if (chunks) {
+        stage = TerrainBuildingChunks;
+        chunks->create(mesh);
+        chunksReady = true;
+        if (stopped()) return;
+    }
+    std::shared_ptr<Mesh> proxy;
+    if (proxyError > 0) {
+        proxy = std::make_shared<Mesh>();
+        stage = TerrainSimplifying;
+        float reach = 0;
+        for (int f = 0; f < mesh.getNumFaces(); f++)
+            reach = std::max(reach, triangleReach(mesh.getFaceVertex(f, 0), mesh.getFaceVertex(f, 1),
+                                                  mesh.getFaceVertex(f, 2)));
+        simplifyMesh(mesh, *proxy, proxyError, reach * ProxyEdgeScale, 0, &proxyStats);
+        if (stopped()) return;
+    }
+    stage = TerrainBuildingTree;
+    octree->create(proxy ? proxy : shared, levels);
+    octree->maxDeviation = proxy ? proxyStats.maxDeviation : 0;
+    if (stopped()) return;
+    stage = TerrainBuildingHeights;
+    collider->create(*octree, resolution);
+    buildMillis = std::chrono::duration<double, std::milli>(Timer::now() - start).count();
+    collisionReady = true;
+    if (stopped()) return;
+
+    // the chunks may be drawing by now, so the bake only reads them and is
+    // applied by the caller
+    //
+    if (chunks && bake) {
+        stage = TerrainBaking;
+        std::string cache = path + ".bake";
+        if (!bake->load(cache, *chunks)) {
+            if (!bake->bake(*octree, *chunks, &cancelled)) {
+                stage = TerrainCancelled;
+                return;
+            }
+            bake->save(cache);
+        }
+    }
+    stage = TerrainReady;
+}
+
+// parsing is weighted as the first half of the job, the chunks,
+// simplifying, the tree, height field and lighting share the rest
+//
+float TerrainLoader::getProgress() const {
+    switch (stage.load()) {
+        case TerrainParsing: return parsed.load() * .5f;
+        case TerrainBuildingChunks: return .5f;
+        case TerrainSimplifying: return .55f;
+        case TerrainBuildingTree: return .65f;
+        case TerrainBuildingHeights: return .8f;
+        case TerrainBaking: return .9f;
+        case TerrainReady: return 1;
+        default: return 0;
+    }
+}
+
+const char *TerrainLoader::getStatus() const {
+    switch (stage.load()) {
+        case TerrainParsing: return "reading terrain";
+        case TerrainBuildingChunks: return "building terrain chunks";
+        case TerrainSimplifying: return "simplifying collision mesh";
+        case TerrainBuildingTree: return "building octree";
+        case TerrainBuildingHeights: return "building height field";
+        case TerrainBaking: return "baking terrain lighting";
+        case TerrainReady: return "terrain ready";
+        case TerrainFailed: return "terrain failed to load";
+        case TerrainCancelled: return "terrain load cancelled";
+        default: return "";
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include "Mesh.h"
+#include "Octree.h"
+#include "TerrainCollider.h"
+#include "TerrainChunks.h"
+#include "MeshSimplifier.h"
+#include "TerrainBake.h"
+
+typedef enum { TerrainIdle, TerrainParsing, TerrainBuildingChunks, TerrainSimplifying, TerrainBuildingTree,
+    TerrainBuildingHeights, TerrainBaking, TerrainReady, TerrainFailed, TerrainCancelled } TerrainLoadStage;
+
+//  Loads the terrain on a background thread: reads the mesh, builds the
+//  level of detail terrain for drawing if given chunks, then the octree
+//  and the exhaust height field, and last the baked lighting if given a
+//  bake.
+//
+//  With a proxyError the octree (and so the collider) is built from a
+//  simplified copy of the mesh that stays within about proxyError of it
+//  (see simplifyMesh()); the chunks always use the full mesh.  Proxy edges
+//  are kept within ProxyEdgeScale times the largest face of the full mesh,
+//  as the contact query slows down with the size of the largest face.
+//
+//  Given a bake as well, the chunks get baked lighting: from the cache file
+//  next to the mesh (path + ".bake") if it matches, otherwise baked through
+//  the octree and saved there.  The loader only fills the bake; the caller
+//  applies it to the chunks once the job is done, as they may be drawn by
+//  then.
+//
+//  The mesh comes from a binary terrain file when path ends in ".mesh",
+//  otherwise from the OBJ at path, through the binary cache next to it
+//  (path + ".mesh", see loadTerrainFile()) when that is up to date; a
+//  parsed OBJ is saved there for the next start.
+//
+//  The mesh is not copied: the octree takes the one it is built
+//  from (the proxy, or else the full mesh) as its shared mesh, and the
+//  rest is freed when the job ends.
+//
+//  Everything is written in place, and each piece comes out of the job at
+//  its own point: the chunks may be read once areChunksReady(), the
+//  octree and collider once isReady(), and the bake once isDone().  The
+//  app starts the scene on the chunks, runs without collision until the
+//  octree and collider are handed over, and applies the lighting last.
+//  Everything the job fills must also outlive it: cancel() (which the
+//  destructor calls) stops it at the next check, within the parse, the
+//  bake or between stages, and waits for the thread to finish.
+//
+class TerrainLoader {
+public:
+    TerrainLoader();
+    ~TerrainLoader();
+    void start(const std::string &path, Octree &octree, TerrainCollider &collider,
+               int levels = 7, int resolution = 256, TerrainChunks *chunks = NULL,
+               float proxyError = 0, TerrainBake *bake = NULL);
+    void wait();
+    void cancel();
+    TerrainLoadStage getStage() const { return (TerrainLoadStage)stage.load(); }
+    bool areChunksReady() const { return chunksReady.load(); }
+    bool isReady() const { return collisionReady.load(); }
+    bool isDone() const { return stage.load() >= TerrainReady; }
+    float getProgress() const;          // whole job, 0 to 1
+    const char *getStatus() const;
+    double buildMillis;                 // time until the octree and collider were ready
+    SimplifyStats proxyStats;           // valid once ready, if there was a proxy
+    static const float ProxyEdgeScale;
+
+private:
+    bool readMesh(const std::string &path, Mesh &mesh);
+    bool stopped();
+    void load(std::string path, Octree *octree, TerrainCollider *collider, int levels, int resolution,
+              TerrainChunks *chunks, float proxyError, TerrainBake *bake);
+
+    std::thread thread;
+    std::atomic<int> stage;
+    std::atomic<float> parsed;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> chunksReady, collisionReady;
+};
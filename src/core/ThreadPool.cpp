@@ -0,0 +1,111 @@
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+// set while a thread runs chunks of a job, pool worker or caller alike
+//
+static thread_local bool inWorker = false;
+
+ThreadPool::ThreadPool(int numThreads) {
+    if (numThreads <= 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    task = NULL;
+    ctx = NULL;
+    count = grain = 0;
+    next = 0;
+    busy = 0;
+    generation = 0;
+    quit = false;
+
+    // the calling thread is one of the lanes, so start one fewer
+    //
+    for (int i = 1; i < numThreads; i++)
+        workers.push_back(std::thread(&ThreadPool::worker, this));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (int i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+// process wide pool shared by the particle, octree and raycast code
+//
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// pull chunks off the shared counter until the range is exhausted
+//
+void ThreadPool::work() {
+    for (;;) {
+        int begin = next.fetch_add(grain);
+        if (begin >= count) break;
+        task(ctx, begin, std::min(begin + grain, count));
+    }
+}
+
+void ThreadPool::worker() {
+    inWorker = true;
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+            busy++;
+        }
+        work();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy--;
+        }
+        finished.notify_all();
+    }
+}
+
+void ThreadPool::run(int n, int chunk, Task t, void *c) {
+    if (n <= 0) return;
+    chunk = std::max(1, chunk);
+
+    // small jobs, nested calls and single threaded pools run inline
+    //
+    if (n <= chunk || inWorker || workers.empty()) {
+        t(c, 0, n);
+        return;
+    }
+
+    // a worker that woke late for the previous job may still be draining
+    // its (empty) range; let it leave before the job state is replaced.
+    //
+    std::lock_guard<std::mutex> job(jobMutex);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return busy == 0; });
+        task = t;
+        ctx = c;
+        count = n;
+        grain = chunk;
+        next = 0;
+        generation++;
+    }
+    wake.notify_all();
+
+    // the caller works on the job too; a parallelFor from its chunks must
+    // run inline like a worker's, jobMutex is already held
+    //
+    inWorker = true;
+    work();
+    inWorker = false;
+
+    // wait until no worker is still inside this job
+    //
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return busy == 0; });
+}
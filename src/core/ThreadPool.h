@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//  Small persistent worker pool for data parallel loops.
+//
+//  parallelFor(n, body) splits [0, n) into chunks of "grain" items and runs
+//  body(begin, end) on the workers and the calling thread until all chunks
+//  are done.  Workers are created once and sleep between jobs, and the body
+//  is passed by pointer (no std::function), so a call does not allocate.
+//  A parallelFor issued from inside a body (on a worker or the calling
+//  thread) simply runs serially.
+//
+class ThreadPool {
+public:
+    ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+
+    static ThreadPool &shared();
+
+    template <class Body>
+    void parallelFor(int n, const Body &body, int grain = 1024) {
+        run(n, grain, &invoke<Body>, (void *)&body);
+    }
+
+    int size() const { return workers.size() + 1; }
+
+private:
+    typedef void (*Task)(void *ctx, int begin, int end);
+
+    template <class Body>
+    static void invoke(void *ctx, int begin, int end) {
+        (*(const Body *)ctx)(begin, end);
+    }
+
+    void run(int n, int grain, Task task, void *ctx);
+    void work();
+    void worker();
+
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;            // one job at a time
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    Task task;
+    void *ctx;
+    int count, grain;
+    std::atomic<int> next;
+    int busy;
+    unsigned generation;
+    bool quit;
+};
@@ -4,11 +4,11 @@
 //  Base class for any object that needs a transform.
 //
 TransformObject::TransformObject() {
-	position = ofVec3f(0, 0, 0);
-	scale = ofVec3f(1, 1, 1);
+	position = Vec3(0, 0, 0);
+	scale = Vec3(1, 1, 1);
 	rotation = 0;
 }
 
-void TransformObject::setPosition(const ofVec3f & pos) {
+void TransformObject::setPosition(const Vec3 & pos) {
 	position = pos;
 }
@@ -1,5 +1,5 @@
 #pragma once
-#include "ofMain.h"
+#include "Vec3.h"
 
 //  Kevin M. Smith - CS 134 SJSU
 //
@@ -9,9 +9,10 @@
 class TransformObject {
 protected:
 	TransformObject();
-	ofVec3f position, scale;
+	Vec3 position, scale;
 	float	rotation;
 	bool	bSelected;
 public:
-    void setPosition(const ofVec3f &);
+    void setPosition(const Vec3 &);
+    const Vec3 &getPosition() const { return position; }
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <math.h>
+#include "Vec3.h"
+
+//  Point and triangle helpers shared by the terrain code (contact query,
+//  chunk resampling, simplification).
+//
+
+// closest point to p on triangle abc (Ericson, Real-Time Collision
+// Detection 5.1.5)
+//
+inline Vec3 closestPointOnTriangle(const Vec3 &p, const Vec3 &a, const Vec3 &b, const Vec3 &c) {
+    Vec3 ab = b - a, ac = c - a, ap = p - a;
+    float d1 = ab.dot(ap), d2 = ac.dot(ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+    Vec3 bp = p - b;
+    float d3 = ab.dot(bp), d4 = ac.dot(bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+    Vec3 cp = p - c;
+    float d5 = ab.dot(cp), d6 = ac.dot(cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    float denom = 1 / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// height of triangle abc above (x, z), false if (x, z) is outside its
+// projection on the ground plane
+//
+inline bool heightOnTriangle(float x, float z, const Vec3 &a, const Vec3 &b, const Vec3 &c, float &h) {
+    float d = (b.z - c.z) * (a.x - c.x) + (c.x - b.x) * (a.z - c.z);
+    if (fabs(d) < 1e-12) return false;
+    float u = ((b.z - c.z) * (x - c.x) + (c.x - b.x) * (z - c.z)) / d;
+    float v = ((c.z - a.z) * (x - c.x) + (a.x - c.x) * (z - c.z)) / d;
+    float w = 1 - u - v;
+    if (u < 0 || v < 0 || w < 0) return false;
+    h = a.y * u + b.y * v + c.y * w;
+    return true;
+}
+
+// distance t along the ray o + t d (t >= 0) to triangle abc, either side
+// (Moller and Trumbore, "Fast, Minimum Storage Ray/Triangle Intersection")
+//
+inline bool rayTriangle(const Vec3 &o, const Vec3 &d, const Vec3 &a, const Vec3 &b, const Vec3 &c,
+                        float &t) {
+    Vec3 e1 = b - a, e2 = c - a;
+    Vec3 p = d.cross(e2);
+    float det = e1.dot(p);
+    if (det == 0) return false;
+    float inv = 1 / det;
+    Vec3 s = o - a;
+    float u = s.dot(p) * inv;
+    if (u < 0 || u > 1) return false;
+    Vec3 q = s.cross(e1);
+    float v = d.dot(q) * inv;
+    if (v < 0 || u + v > 1) return false;
+    t = e2.dot(q) * inv;
+    return t >= 0;
+}
+
+// larger of the triangle's x and z extents
+//
+inline float triangleReach(const Vec3 &a, const Vec3 &b, const Vec3 &c) {
+    float dx = fmaxf(a.x, fmaxf(b.x, c.x)) - fminf(a.x, fminf(b.x, c.x));
+    float dz = fmaxf(a.z, fmaxf(b.z, c.z)) - fminf(a.z, fminf(b.z, c.z));
+    return fmaxf(dx, dz);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <math.h>
+
+//  3D vector used by the simulation core.
+//
+//  Same public fields and method names as the ofVec3f subset the particle
+//  code always used, so the core compiles without openFrameworks.  The
+//  layout is three packed floats, identical to glm::vec3 / ofVec3f, which
+//  lets the app layer hand arrays of Vec3 straight to GL.
+//
+class Vec3 {
+public:
+    float x, y, z;
+
+    Vec3() : x(0), y(0), z(0) {}
+    Vec3(float x, float y, float z = 0) : x(x), y(y), z(z) {}
+
+    void set(float px, float py, float pz) { x = px; y = py; z = pz; }
+    void set(const Vec3 &v) { x = v.x; y = v.y; z = v.z; }
+
+    float operator[](int i) const { return (&x)[i]; }
+    float &operator[](int i) { return (&x)[i]; }
+
+    Vec3 operator+(const Vec3 &v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+    Vec3 operator-(const Vec3 &v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+    Vec3 operator-() const { return Vec3(-x, -y, -z); }
+    Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+    Vec3 operator/(float s) const { return Vec3(x / s, y / s, z / s); }
+    Vec3 &operator+=(const Vec3 &v) { x += v.x; y += v.y; z += v.z; return *this; }
+    Vec3 &operator-=(const Vec3 &v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    Vec3 &operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+    Vec3 &operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+    bool operator==(const Vec3 &v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const Vec3 &v) const { return !(*this == v); }
+
+    float dot(const Vec3 &v) const { return x * v.x + y * v.y + z * v.z; }
+    Vec3 cross(const Vec3 &v) const {
+        return Vec3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+    }
+    float lengthSquared() const { return x * x + y * y + z * z; }
+    float length() const { return sqrtf(lengthSquared()); }
+    float squareDistance(const Vec3 &v) const { return (*this - v).lengthSquared(); }
+    float distance(const Vec3 &v) const { return (*this - v).length(); }
+    Vec3 getNormalized() const {
+        float l = length();
+        return (l > 0) ? *this / l : *this;
+    }
+    Vec3 &normalize() { *this = getNormalized(); return *this; }
+};
+
+inline Vec3 operator*(float s, const Vec3 &v) { return v * s; }
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <float.h>
+#include <math.h>
+#include "Vec3.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VEC4_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VEC4_NEON 1
+#endif
+
+//  Four wide, 16 byte aligned float vector for the hot spatial queries:
+//  x, y, z and a w lane the 3D operations carry along and ignore.  Uses
+//  SSE2 on x86, NEON on ARM and plain floats elsewhere.
+//
+//  Vec3 stays the type for stored data (it must keep glm's packed three
+//  float layout for GL and the file formats); Vec4f is loaded from it
+//  where a query does enough math per value to pay off, and holds the
+//  corners of the octree's boxes (see Aabb and Box).
+//
+class alignas(16) Vec4f {
+public:
+#if VEC4_SSE
+    typedef __m128 Lanes;
+#elif VEC4_NEON
+    typedef float32x4_t Lanes;
+#else
+    struct Lanes { float f[4]; };
+#endif
+
+    Vec4f() { set(0, 0, 0, 0); }
+    Vec4f(float x, float y, float z, float w = 0) { set(x, y, z, w); }
+    Vec4f(const Vec3 &v, float w = 0) { set(v.x, v.y, v.z, w); }
+    Vec4f(Lanes l) : lanes(l) {}
+
+    void set(float x, float y, float z, float w) {
+#if VEC4_SSE
+        lanes = _mm_set_ps(w, z, y, x);
+#else
+        float f[4] = { x, y, z, w };
+        load(f);
+#endif
+    }
+    void load(const float *f) {
+#if VEC4_SSE
+        lanes = _mm_loadu_ps(f);
+#elif VEC4_NEON
+        lanes = vld1q_f32(f);
+#else
+        for (int i = 0; i < 4; i++) lanes.f[i] = f[i];
+#endif
+    }
+    float operator[](int i) const { return ((const float *)&lanes)[i]; }
+    Vec3 xyz() const { return Vec3((*this)[0], (*this)[1], (*this)[2]); }
+
+    Vec4f operator+(const Vec4f &v) const {
+#if VEC4_SSE
+        return _mm_add_ps(lanes, v.lanes);
+#elif VEC4_NEON
+        return vaddq_f32(lanes, v.lanes);
+#else
+        Lanes r; for (int i = 0; i < 4; i++) r.f[i] = lanes.f[i] + v.lanes.f[i]; return r;
+#endif
+    }
+    Vec4f operator-(const Vec4f &v) const {
+#if VEC4_SSE
+        return _mm_sub_ps(lanes, v.lanes);
+#elif VEC4_NEON
+        return vsubq_f32(lanes, v.lanes);
+#else
+        Lanes r; for (int i = 0; i < 4; i++) r.f[i] = lanes.f[i] - v.lanes.f[i]; return r;
+#endif
+    }
+    Vec4f operator*(const Vec4f &v) const {
+#if VEC4_SSE
+        return _mm_mul_ps(lanes, v.lanes);
+#elif VEC4_NEON
+        return vmulq_f32(lanes, v.lanes);
+#else
+        Lanes r; for (int i = 0; i < 4; i++) r.f[i] = lanes.f[i] * v.lanes.f[i]; return r;
+#endif
+    }
+    static Vec4f min(const Vec4f &a, const Vec4f &b) {
+#if VEC4_SSE
+        return _mm_min_ps(a.lanes, b.lanes);
+#elif VEC4_NEON
+        return vminq_f32(a.lanes, b.lanes);
+#else
+        Lanes r; for (int i = 0; i < 4; i++) r.f[i] = a.lanes.f[i] < b.lanes.f[i] ? a.lanes.f[i] : b.lanes.f[i]; return r;
+#endif
+    }
+    static Vec4f max(const Vec4f &a, const Vec4f &b) {
+#if VEC4_SSE
+        return _mm_max_ps(a.lanes, b.lanes);
+#elif VEC4_NEON
+        return vmaxq_f32(a.lanes, b.lanes);
+#else
+        Lanes r; for (int i = 0; i < 4; i++) r.f[i] = a.lanes.f[i] > b.lanes.f[i] ? a.lanes.f[i] : b.lanes.f[i]; return r;
+#endif
+    }
+
+    // x, y and z of a are each at most those of b (w is ignored)
+    //
+    static bool lessEqual3(const Vec4f &a, const Vec4f &b) {
+#if VEC4_SSE
+        return (_mm_movemask_ps(_mm_cmple_ps(a.lanes, b.lanes)) & 7) == 7;
+#elif VEC4_NEON
+        uint32x4_t m = vcleq_f32(a.lanes, b.lanes);
+        return vgetq_lane_u32(m, 0) && vgetq_lane_u32(m, 1) && vgetq_lane_u32(m, 2);
+#else
+        return a.lanes.f[0] <= b.lanes.f[0] && a.lanes.f[1] <= b.lanes.f[1] && a.lanes.f[2] <= b.lanes.f[2];
+#endif
+    }
+
+    float x() const {
+#if VEC4_SSE
+        return _mm_cvtss_f32(lanes);
+#elif VEC4_NEON
+        return vgetq_lane_f32(lanes, 0);
+#else
+        return lanes.f[0];
+#endif
+    }
+
+    // smallest / largest of x, y and z
+    //
+    float min3() const {
+#if VEC4_SSE
+        __m128 m = _mm_min_ss(lanes, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(2, 2, 2, 2))));
+#else
+        float a = (*this)[0], b = (*this)[1], c = (*this)[2];
+        float m = a < b ? a : b;
+        return m < c ? m : c;
+#endif
+    }
+    float max3() const {
+#if VEC4_SSE
+        __m128 m = _mm_max_ss(lanes, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(lanes, lanes, _MM_SHUFFLE(2, 2, 2, 2))));
+#else
+        float a = (*this)[0], b = (*this)[1], c = (*this)[2];
+        float m = a > b ? a : b;
+        return m > c ? m : c;
+#endif
+    }
+
+    Lanes lanes;
+};
+
+//  Ray prepared for slab tests: origin and the reciprocal direction, with
+//  zero components replaced by a huge finite value so that a ray lying in
+//  a box's face plane never produces 0 * inf.
+//
+class Ray4 {
+public:
+    Ray4(const Vec3 &o, const Vec3 &d) : origin(o) {
+        float inv[3];
+        for (int i = 0; i < 3; i++) inv[i] = fabsf(d[i]) > 1e-30f ? 1 / d[i] : copysignf(1e30f, d[i]);
+        invDir = Vec4f(inv[0], inv[1], inv[2]);
+    }
+    Vec4f origin;
+    Vec4f invDir;
+};
+
+//  Axis aligned box of two Vec4f corners.  Empty (min above max) until
+//  something is added.  The octree's Box is built on it.
+//
+class Aabb {
+public:
+    Aabb() : lo(FLT_MAX, FLT_MAX, FLT_MAX), hi(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+    Aabb(const Vec3 &min, const Vec3 &max) : lo(min), hi(max) {}
+
+    bool isEmpty() const { return lo.x() > hi.x(); }
+    void add(const Vec3 &p) { Vec4f v(p); lo = Vec4f::min(lo, v); hi = Vec4f::max(hi, v); }
+    void add(const Aabb &b) { lo = Vec4f::min(lo, b.lo); hi = Vec4f::max(hi, b.hi); }
+
+    // closed on every face, so boxes that share a face both hold points on it
+    //
+    bool contains(const Vec4f &p) const { return Vec4f::lessEqual3(lo, p) && Vec4f::lessEqual3(p, hi); }
+    bool overlaps(const Aabb &b) const { return Vec4f::lessEqual3(lo, b.hi) && Vec4f::lessEqual3(b.lo, hi); }
+
+    // parameter interval [t0, t1] over which the ray's line is inside the
+    // box, empty if t0 > t1
+    //
+    void slab(const Ray4 &ray, float &t0, float &t1) const {
+        Vec4f a = (lo - ray.origin) * ray.invDir;
+        Vec4f b = (hi - ray.origin) * ray.invDir;
+        t0 = Vec4f::min(a, b).max3();
+        t1 = Vec4f::max(a, b).min3();
+    }
+
+    // distance at which the ray enters the box, if it does before maxDist
+    // (0 if it starts inside)
+    //
+    bool enter(const Ray4 &ray, float maxDist, float &tRtn) const {
+        if (isEmpty()) return false;
+        float t0, t1;
+        slab(ray, t0, t1);
+        if (t0 < 0) t0 = 0;
+        if (t1 > maxDist) t1 = maxDist;
+        tRtn = t0;
+        return t0 <= t1;
+    }
+
+    Vec4f lo, hi;
+};
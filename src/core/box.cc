@@ -0,0 +1,24 @@
+#include "Vec3.h"
+#include "ray.h"
+#include "box.h"
+#include "Vec4.h"
+  
+/*
+ * Ray-box intersection using IEEE numerical properties to ensure that the
+ * test is both robust and efficient, as described in:
+ *
+ *      Amy Williams, Steve Barrus, R. Keith Morley, and Peter Shirley
+ *      "An Efficient and Robust Ray-Box Intersection Algorithm"
+ *      Journal of graphics tools, 10(1):49-54, 2005
+ *
+ */
+
+bool Box::intersect(const Ray &r, float t0, float t1) const {
+  float tmin, tmax;
+
+  // the same slab test over all three axes at once; Ray4 stands in a huge
+  // finite reciprocal for a zero direction component, where the paper
+  // relies on IEEE infinities and the sign table
+  bounds.slab(Ray4(r.origin, r.direction), tmin, tmax);
+  return ( (tmin <= tmax) && (tmin < t1) && (tmax > t0) );
+}
@@ -0,0 +1,54 @@
+#ifndef _BOX_H_
+#define _BOX_H_
+
+#include <assert.h>
+#include "Vec3.h"
+#include "ray.h"
+#include "Vec4.h"
+
+/*
+ * Axis-aligned bounding box class, for use with the optimized ray-box
+ * intersection test described in:
+ *
+ *      Amy Williams, Steve Barrus, R. Keith Morley, and Peter Shirley
+ *      "An Efficient and Robust Ray-Box Intersection Algorithm"
+ *      Journal of graphics tools, 10(1):49-54, 2005
+ *
+ */
+
+class Box {
+  public:
+    Box() : bounds(Vec3(), Vec3()) { }     // both corners at the origin
+    Box(const Vec3 &min, const Vec3 &max) : bounds(min, max) {
+ //     assert(min < max);
+    }
+    // (t0, t1) is the interval for valid hits
+    bool intersect(const Ray &, float t0, float t1) const;
+
+    // corners, four wide (see Aabb); the tests below run on all three axes
+    // at once
+    Aabb bounds;
+
+	Vec3 min() const { return bounds.lo.xyz(); }
+	Vec3 max() const { return bounds.hi.xyz(); }
+	bool inside(const Vec3 &p) const {
+		return bounds.contains(Vec4f(p));
+	}
+	bool inside(const Vec3 *points, int size) const {
+		for (int i = 0; i < size; i++)
+			if (!inside(points[i])) return false;
+		return true;
+	}
+
+	// implement for Homework Project
+	//
+	 bool overlap(const Box &box) const {
+         return bounds.overlaps(box.bounds);
+	}
+
+	Vec3 center() const {
+		return ((bounds.lo + bounds.hi) * Vec4f(.5f, .5f, .5f)).xyz();
+	}
+};
+
+#endif // _BOX_H_
@@ -7,7 +7,32 @@
 //
 void ofApp::setup(){
     
-    background.load("images/space.jpg");
+    // start the slow work first: the drawn chunks, the terrain octree (from
+    // a collision proxy within .05 of the terrain, half the landing skin),
+    // height field and lighting build on a loader thread and the background
+    // image decodes on another, while the lander and sound load on the main
+    // thread over the first few frames (see loadAssets()).  The octree is
+    // lazy: only its top levels are built up front, the rest as the lander
+    // and rays reach it
+    //
+    Profiler::get().setThreadName("main");
+    octrees.bLazy = true;
+    terrainLoader.start(ofToDataPath("geo/mars-low-5x-v2.obj"), octrees, terrain, 7, 256, &terrainChunks,
+                        .05, &terrainBake);
+    backgroundLoad = std::async(std::launch::async, [this] {
+        return ofLoadImage(backgroundPixels, "images/space.jpg");
+    });
+    
+    // the scene draws the terrain from the loader's chunks, under the
+    // transform the Assimp model has with these settings.  The model
+    // itself is only parsed when it is drawn (see loadTerrainModel())
+    //
+    mars.setScaleNormalization(false);
+    mars.setScale(5, 5, 5);
+    terrainModel = mars.getModelMatrix();
+    
+    lidarPattern.grid(glm::radians(60.0f), glm::radians(60.0f), 64, 64);
+    lidarPoints.setMode(OF_PRIMITIVE_POINTS);
     
     bWireframe = false;
     bDisplayPoints = false;
@@ -28,16 +53,6 @@ void ofApp::setup(){
     //
     initLightingAndMaterials();
     
-    //load up mars and lander model
-    mars.loadModel("geo/mars-low-5x-v2.obj");
-    //mars.loadModel("geo/mars-terrain-v2.obj");
-    mars.setScale(5, 5, 5);
-    mars.setScaleNormalization(false);
-    //lander.loadModel("geo/lander.obj");
-    lander.loadModel("geo/starship.fbx");
-    lander.setScale(0.03, 0.03, 0.03);
-    lander.setScaleNormalization(false);
-    
     //camera module
     camera = &cam;
     groundCam.setOrientation(ofVec3f(-90, 0, 0));
@@ -46,8 +61,10 @@ void ofApp::setup(){
     trackCam.setPosition(0, 1, 0);
     trackCam.setNearClip(.1);
     
-    octrees.create(mars.getMesh(0), 7);
-    collided = false;
+    // exhaust collides with a height field built from the same tree, using
+    // the same mesh space offset as detectCollision()
+    //
+    terrain.offset = Vec3(6, 6, 6);
     
     cam.setDistance(10);
     cam.setNearClip(.1);
@@ -56,40 +73,23 @@ void ofApp::setup(){
     ofSetFrameRate(60);
     ofSetBackgroundColor(ofColor::black);
     
-    //sound system
-    if (noise.load("sounds/thruster2.mp3")) {
-        noise.setLoop(true);
-        soundFileLoaded = true;
-    }
-    
-    //engine emitter
-    engine.setRate(600);
-    engine.setParticleRadius(.010);
-    engine.setEmitterType(DiscEmitter);
-    engine.setLifespan(0.5);
-    engine.visible = false;
-    rocket.radius = 0.00010;
-    
-    //rocket lander particles
-    rocket.lifespan = 50;
-    rocket.position.set(0, 10, 0);
-    lander.setPosition(rocket.position.x, rocket.position.y, rocket.position.z);
-    sys.add(rocket);
-    sys.addForce(&thrust);
-    sys.addForce(&impulseForce);
-    
-    //engine forces
-    engine.sys->addForce(new TurbulenceForce(ofVec3f(-2, -1, -3), ofVec3f(1, 2, 5)));
-    engine.sys->addForce(new ImpulseRadialForce(10));
-    engine.sys->addForce(new CyclicForce(20));
-    engine.setGroupSize(10);
-    
-    //rocket's gravity force
-    sys.addForce(new GravityForce(ofVec3f(0, -.01, 0)));
-    
-    //fuel system, 120000ms = 120s
-    fuel = 120000;
-    thrustTime = 0;
+    // simulation time follows the OF timer, sampled each frame and passed
+    // to the sim with its step
+    //
+    Clock::setDefault(&clock);
+    
+    // flight data goes to bin/data/telemetry.csv, written off the frame
+    // by its own thread (neither is started with LANDER_TELEMETRY 0)
+    //
+#if LANDER_TELEMETRY
+    pipeline.acquire().telemetry = &telemetry;
+    if (!telemetryWriter.start(telemetry, ofToDataPath("telemetry.csv")))
+        cout << "Error: can't write telemetry.csv" << endl;
+#endif
+    
+    // the lander, its engine and fuel live in sim (see LanderSim)
+    //
+    lander.setPosition(0, 10, 0);
     ofResetElapsedTimeCounter();
     
     //lighting system
@@ -145,26 +145,44 @@ void ofApp::setup(){
 //
 void ofApp::update() {
     
-    altitudes = sys.particles[0].position.y+6;
-    sys.update();
-    engine.update();
-    engine.setPosition(sys.particles[0].position);
-    lander.setPosition(sys.particles[0].position.x, sys.particles[0].position.y+2, sys.particles[0].position.z);
+    // frame work time (update + draw, not the vsync wait) drives the
+    // exhaust particle budget
+    //
+    frameStartMicros = ofGetSystemTimeMicros();
+    if (Profiler::isEnabled()) Profiler::get().collect();
+    PROFILE_SCOPE("ofApp::update");
+    loadAssets();
+    if (!bSceneReady) return;
+    
+    // publish the frame simulated while the last one was drawn and start
+    // simulating the next (see SimPipeline)
+    //
+    pipeline.acquire().engine.sys->focus = toSim(camera->getPosition());
+    pipeline.step(ofGetElapsedTimeMillis(), ofGetFrameRate());
+    const LanderFrame &frame = pipeline.current();
+    const Vec3 &pos = frame.landerPosition;
+    lander.setPosition(pos.x, pos.y+2, pos.z);
     lander.update();
-    detectCollision();
     
     // Camera
     //
-    groundCam.setPosition(sys.particles[0].position + ofVec3f(0.1, 0, 0.1));
-    sideCam.setPosition(sys.particles[0].position + ofVec3f(-1.5, 0, 0));
+    groundCam.setPosition(toOf(pos) + ofVec3f(0.1, 0, 0.1));
+    sideCam.setPosition(toOf(pos) + ofVec3f(-1.5, 0, 0));
     trackCam.lookAt(lander.getPosition());
+    
+    if (bLidar && bCollisionReady) scanTerrain();
 }
 //--------------------------------------------------------------
 void ofApp::draw() {
+    PROFILE_SCOPE("ofApp::draw");
     
-    if(fuel > 0){
+    if (!bSceneReady) {
+        drawLoadingProgress();
+        return;
+    }
+    const LanderFrame &frame = pipeline.current();
+    if(!frame.gameOver){
         bLanderLoaded = true;
-        gameOver = false;
         ofSetColor(255, 255, 255);
         ofDisableDepthTest();
         background.draw(0, 0, ofGetWindowWidth(), ofGetWindowHeight());
@@ -179,12 +197,12 @@ void ofApp::draw() {
         
         
         //draw particle and engine
-        sys.draw();
-        engine.draw();
+        drawFrame(frame, &exhaustRenderer);
         
         if (bWireframe) {                    // wireframe mode  (include axis)
             ofDisableLighting();
             ofSetColor(ofColor::red);
+            loadTerrainModel();
             mars.drawWireframe();
             lander.drawWireframe();
             if (bRoverLoaded) {
@@ -193,7 +211,11 @@ void ofApp::draw() {
         }
         else {
             ofEnableLighting();              // shaded mode
-            mars.drawFaces();
+            if (bChunkedTerrain && terrainRenderer.isReady()) drawTerrain();
+            else {
+                loadTerrainModel();
+                mars.drawFaces();
+            }
             lander.drawFaces();
             
             if (bRoverLoaded) {
@@ -201,26 +223,25 @@ void ofApp::draw() {
             }
         }
         
+        if (bLidar && bCollisionReady) drawLidar();
+        
         ofNoFill();
         camera->end();
     }
     else{
         bLanderLoaded = false;
-        gameOver = true;
-        fuel = 0;
         noise.stop();
-        engine.stop();
         string noFuel;
         noFuel += "Game Over, No More Fuel! Click R to Reset";
         ofDrawBitmapString(noFuel, ofPoint(ofGetWindowWidth()/2, ofGetWindowHeight()/2));
         
     }
     string fuelAmount;
-    fuelAmount += "Fuel: " + std::to_string(fuel) + " ms remaining";
+    fuelAmount += "Fuel: " + std::to_string(frame.fuel) + " ms remaining";
     ofDrawBitmapString(fuelAmount, ofPoint(10, 20));
     
     string landed;
-    if(collided == true){
+    if(frame.collided == true){
         landed += "Landing Status: landed";
         ofDrawBitmapString(landed, ofPoint(10, 40));
     }
@@ -230,14 +251,240 @@ void ofApp::draw() {
     }
     
     string altitude;
-    if(collided == true){
+    if(frame.collided == true){
         altitude += "Altitude: 0";
         ofDrawBitmapString(altitude, ofPoint(10, 60));
     }
     else{
-        altitude += "Altitude: " + std::to_string(altitudes);
+        altitude += "Altitude: " + std::to_string(frame.altitudes);
+        if (frame.timeToImpact >= 0) altitude += " (impact in " + std::to_string(frame.timeToImpact) + " s)";
         ofDrawBitmapString(altitude, ofPoint(10, 60));
     }
+    
+    string contacts;
+    contacts += "Exhaust Contacts: " + std::to_string(frame.contacts);
+    ofDrawBitmapString(contacts, ofPoint(10, 80));
+    
+    string budget;
+    budget += "Exhaust Budget: " + std::to_string((int)(frame.budgetLevel * 100)) + "% (" +
+        std::to_string(frame.budgetMillis) + " ms/frame, 1/" + std::to_string(frame.budgetSlices) + " far updates)";
+    ofDrawBitmapString(budget, ofPoint(10, 100));
+    
+    string recording;
+    if (recorder.recording) {
+        recording += "Recording: frame " + std::to_string(frame.frame) + " (F5 to stop)";
+        ofDrawBitmapString(recording, ofPoint(10, 120));
+    }
+    else if (bReplayed) {
+        recording += "Replay: " + std::to_string(replayStats.frames) + " frames, " +
+            std::to_string(replayStats.meanFrameMillis()) + " ms/frame avg, " +
+            std::to_string(replayStats.maxFrameMillis) + " ms max";
+        ofDrawBitmapString(recording, ofPoint(10, 120));
+    }
+    
+    if (bLidar && bCollisionReady) {
+        char line[160];
+        snprintf(line, sizeof(line), "Lidar: %d/%d returns, %.2f ms, %.0f rays/s per core (h off)",
+                 lidarScan.returns, (int)lidarScan.distances.size(), lidarScan.millis,
+                 lidarScan.raysPerSecond() / lidarScan.threads);
+        ofDrawBitmapString(line, ofPoint(10, 140));
+    }
+    string progress = string(terrainLoader.getStatus()) + " " +
+        std::to_string((int)(terrainLoader.getProgress() * 100)) + "%";
+    if (!bCollisionReady) ofDrawBitmapString("Collision: " + progress, ofPoint(10, 140));
+    if (bChunkedTerrain && terrainRenderer.isReady()) {
+        string chunks;
+        chunks += "Terrain: " + std::to_string(terrainDraws.size()) + "/" + std::to_string(terrainChunks.chunks.size()) +
+            " chunks, " + std::to_string(terrainRenderer.triangles) + " triangles (F9 full model)";
+        if (bCollisionReady && !bTerrainDone) chunks += ", " + progress;
+        ofDrawBitmapString(chunks, ofPoint(10, 160));
+    }
+    if (bShowProfile) drawProfile();
+    
+    pipeline.frameTime((ofGetSystemTimeMicros() - frameStartMicros) / 1000.0);
+}
+
+//--------------------------------------------------------------
+// closing during startup stops the terrain job rather than waiting out a
+// bake, before the members it writes go away; the telemetry writer drains
+// what the sim logged and closes its file
+//
+void ofApp::exit() {
+    terrainLoader.cancel();
+#if LANDER_TELEMETRY
+    telemetryWriter.stop();
+#endif
+}
+
+//--------------------------------------------------------------
+// finish startup loading a piece at a time.  GL and sound resources have
+// to be created here on the main thread, so the lander and sound load
+// one per frame once the first (progress) frame is up; the work done on
+// other threads is picked up as it completes.  The scene starts as soon
+// as the terrain loader has built the chunks (or, if it failed, draws the
+// full model); collision follows with the octree and the baked lighting
+// is applied when the job is done.
+//
+void ofApp::loadAssets() {
+    if (!bBackgroundLoaded && backgroundLoad.valid() &&
+        backgroundLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        if (backgroundLoad.get()) background.setFromPixels(backgroundPixels);
+        bBackgroundLoaded = true;
+    }
+    
+    if (!bSceneReady && terrainLoader.areChunksReady()) {
+        terrainRenderer.upload(terrainChunks);
+        bSceneReady = true;
+    }
+    if (!bCollisionReady && terrainLoader.isReady()) {
+        pipeline.acquire().setTerrain(&octrees, &terrain);
+        bCollisionReady = true;
+        cout << "terrain octree ready in " << terrainLoader.buildMillis << " ms" << endl;
+        const SimplifyStats &proxy = terrainLoader.proxyStats;
+        if (proxy.sourceFaces > 0)
+            cout << "collision proxy " << proxy.faces << " of " << proxy.sourceFaces <<
+                " faces, within " << octrees.maxDeviation << " of the terrain" << endl;
+    }
+    if (!bTerrainDone && terrainLoader.isDone()) {
+        bTerrainDone = bSceneReady = true;
+        if (terrainBake.isReady()) {
+            terrainBake.apply(terrainChunks);
+            terrainRenderer.upload(terrainChunks);
+            cout << "terrain lighting " << (terrainBake.millis > 0 ? "baked in " + std::to_string(terrainBake.millis) +
+                " ms" : string("loaded from cache")) << endl;
+        }
+    }
+    
+    if (ofGetFrameNum() < 1) return;
+    switch (loadStep) {
+        case 0:
+            //load up lander model
+            //lander.loadModel("geo/lander.obj");
+            lander.loadModel("geo/starship.fbx");
+            lander.setScale(0.03, 0.03, 0.03);
+            lander.setScaleNormalization(false);
+            break;
+        case 1:
+            //sound system
+            if (noise.load("sounds/thruster2.mp3")) {
+                noise.setLoop(true);
+                soundFileLoaded = true;
+            }
+            break;
+        default:
+            return;
+    }
+    loadStep++;
+}
+
+// F7 overlay: rolling p50/p95/p99 of every profiled scope, nested scopes
+// indented under their callers
+//
+void ofApp::drawProfile() {
+    vector<ProfileStats> stats = Profiler::get().summary();
+    char line[160];
+    float y = 180;
+    snprintf(line, sizeof(line), "%-32s %8s %8s %8s %6s", "Profile (ms, F8 saves trace)", "p50", "p95", "p99", "calls");
+    ofDrawBitmapString(line, ofPoint(10, y));
+    for (int i = 0; i < stats.size(); i++) {
+        const ProfileStats &s = stats[i];
+        string name = string(s.depth * 2, ' ') + s.name;
+        snprintf(line, sizeof(line), "%-32s %8.3f %8.3f %8.3f %6d", name.c_str(), s.p50, s.p95, s.p99, s.calls);
+        y += 16;
+        ofDrawBitmapString(line, ofPoint(10, y));
+    }
+}
+
+// full terrain model through Assimp, for wireframe, F9 and a failed
+// terrain load.  Parsing the OBJ takes a while, so it is loaded the
+// first time one of those draws it rather than at startup
+//
+void ofApp::loadTerrainModel() {
+    if (bTerrainModelLoaded) return;
+    bTerrainModelLoaded = true;
+    if (!mars.loadModel("geo/mars-low-5x-v2.obj")) cout << "Error: Can't load terrain model" << endl;
+    mars.setScaleNormalization(false);
+    mars.setScale(5, 5, 5);
+}
+
+// chunked terrain under the terrain model's transform.  The camera is
+// taken into mesh space for chunk selection, where the chunks' errors are.
+//
+void ofApp::drawTerrain() {
+    glm::mat4 model = terrainModel;
+    glm::mat4 toMesh = glm::inverse(model);
+    glm::vec3 eye(toMesh * glm::vec4(camera->getGlobalPosition(), 1));
+    glm::vec3 forward(toMesh * glm::vec4(camera->getLookAtDir(), 0));
+    glm::vec3 up(toMesh * glm::vec4(camera->getUpDir(), 0));
+    float scale = glm::length(forward);         // mesh units per world unit
+    float nearClip = camera->getNearClip() * scale;
+    float farClip = camera->getFarClip() * scale;
+    TerrainView view;
+    view.set(toSim(eye), toSim(forward), toSim(up), camera->getFov(),
+             ofGetViewportWidth() / (float)ofGetViewportHeight(), nearClip, farClip, ofGetViewportHeight());
+    terrainChunks.select(view, terrainDraws);
+
+    ofPushMatrix();
+    ofMultMatrix(model);
+    ofSetColor(ofColor::white);
+    terrainRenderer.draw(terrainDraws);
+    ofPopMatrix();
+}
+
+// hazard lidar sweep down from the lander, from the same point in terrain
+// mesh space as the sim's collision query
+//
+void ofApp::scanTerrain() {
+    const LanderFrame &frame = pipeline.current();
+    lidar.setPose(frame.landerPosition + Vec3(6, 6, 6), Vec3(0, -1, 0), Vec3(0, 0, 1));
+    lidar.scan(octrees, lidarPattern, lidarScan);
+    lidarPoints.clear();
+    for (int i = 0; i < lidarScan.points.size(); i++) {
+        if (lidarScan.distances[i] < 0) continue;
+        const Vec3 &p = lidarScan.points[i];
+        lidarPoints.addVertex(glm::vec3(p.x, p.y, p.z));
+    }
+}
+
+void ofApp::drawLidar() {
+    ofPushMatrix();
+    ofMultMatrix(terrainModel);
+    ofDisableLighting();
+    ofSetColor(ofColor::green);
+    lidarPoints.draw();
+    ofPopMatrix();
+}
+
+// F8 writes the profiler's recent history to bin/data/trace.json, for
+// chrome://tracing or ui.perfetto.dev
+//
+void ofApp::exportTrace() {
+    Profiler::get().collect();
+    if (Profiler::get().exportTrace(ofToDataPath("trace.json")))
+        cout << "saved trace.json" << endl;
+    else cout << "Error: can't save trace.json" << endl;
+}
+
+// startup screen until the terrain is up
+//
+void ofApp::drawLoadingProgress() {
+    ofDisableDepthTest();
+    ofSetColor(255, 255, 255);
+    if (bBackgroundLoaded) background.draw(0, 0, ofGetWindowWidth(), ofGetWindowHeight());
+    
+    float w = ofGetWindowWidth() / 2;
+    float x = ofGetWindowWidth() / 4;
+    float y = ofGetWindowHeight() / 2;
+    float progress = (terrainLoader.getProgress() + loadStep) / 3;
+    ofNoFill();
+    ofDrawRectangle(x, y, w, 20);
+    ofFill();
+    ofDrawRectangle(x, y, w * progress, 20);
+    
+    string status;
+    status += "Loading: " + string(terrainLoader.getStatus());
+    ofDrawBitmapString(status, ofPoint(x, y - 10));
+    ofEnableDepthTest();
 }
 
 
@@ -270,6 +517,16 @@ void ofApp::drawAxis(ofVec3f location) {
 
 void ofApp::keyPressed(int key) {
     
+    LanderControl control;
+    if (controlForKey(key, control)) {
+        LanderSim &sim = pipeline.acquire();
+        sim.press(control);
+        if (control < Restart && !sim.gameOver) {
+            soundPlayer();
+            noise.play();
+        }
+    }
+    
     switch (key) {
         case 'B':
         case 'b':
@@ -286,6 +543,7 @@ void ofApp::keyPressed(int key) {
             break;
         case 'H':
         case 'h':
+            bLidar = !bLidar;
             break;
         case 'L':
         case 'l':
@@ -297,11 +555,7 @@ void ofApp::keyPressed(int key) {
             break;
         case 'r':
             cam.reset();
-            if(gameOver == true){
-                gameOver = false;
-                fuel = 120000;
-                lander.setPosition(rocket.position.x, rocket.position.y, rocket.position.z);
-            }
+            lander.setPosition(0, 10, 0);
             break;
         case 's':
             savePicture();
@@ -330,84 +584,6 @@ void ofApp::keyPressed(int key) {
             break;
         case OF_KEY_DEL:
             break;
-        case OF_KEY_UP:
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(0, .5, 0));
-                engine.setVelocity(ofVec3f(0, -5, 0));
-                engine.start();
-                noise.play();
-            }
-            break;
-        case OF_KEY_DOWN:
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(0, -.5, 0));
-                engine.setVelocity(ofVec3f(0, -5, 0));
-                engine.start();
-                noise.play();
-            }
-            break;
-        case OF_KEY_LEFT:
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(-.5, 0, 0));
-                engine.setVelocity(ofVec3f(5, -5, 0));
-                engine.start();
-                noise.play();
-            }
-            break;
-        case OF_KEY_RIGHT:
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(.5, 0, 0));
-                engine.setVelocity(ofVec3f(-5, -5, 0));
-                engine.start();
-                noise.play();
-            }
-            break;
-        case 'z':
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(0, 0, 0.5));
-                engine.setVelocity(ofVec3f(0, -5, -5));
-                engine.start();
-                noise.play();
-            }
-            break;
-        case 'x':
-            if(gameOver == true){
-                engine.stop();
-            }
-            else{
-                thrustTime = ofGetElapsedTimeMillis();
-                soundPlayer();
-                thrust.add(ofVec3f(0, 0, -0.5));
-                engine.setVelocity(ofVec3f(0, -5, 5));
-                engine.start();
-                noise.play();
-            }
-            break;
         case OF_KEY_F1:
             camera = &cam;
             break;
@@ -420,6 +596,22 @@ void ofApp::keyPressed(int key) {
         case OF_KEY_F4:
             camera = &trackCam;
             break;
+        case OF_KEY_F5:
+            toggleRecording();
+            break;
+        case OF_KEY_F6:
+            replayRecording();
+            break;
+        case OF_KEY_F7:
+            bShowProfile = !bShowProfile;
+            Profiler::get().setEnabled(bShowProfile);
+            break;
+        case OF_KEY_F8:
+            exportTrace();
+            break;
+        case OF_KEY_F9:
+            bChunkedTerrain = !bChunkedTerrain;
+            break;
         default:
             break;
     }
@@ -438,7 +630,11 @@ void ofApp::togglePointsDisplay() {
 }
 
 void ofApp::keyReleased(int key) {
-    ofResetElapsedTimeCounter();
+    LanderControl control;
+    if (controlForKey(key, control)) {
+        pipeline.acquire().release(control);
+        if (control < Restart) noise.stop();
+    }
     switch (key) {
             
         case OF_KEY_ALT:
@@ -450,54 +646,75 @@ void ofApp::keyReleased(int key) {
             break;
         case OF_KEY_SHIFT:
             break;
-        case OF_KEY_UP:
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
-        case OF_KEY_DOWN:
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
-        case OF_KEY_LEFT:
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
-        case OF_KEY_RIGHT:
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
-        case 'z':
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
-        case 'x':
-            noise.stop();
-            engine.stop();
-            thrust.set(ofVec3f(0, 0, 0));
-            fuel -= thrustTime;
-            ofResetElapsedTimeCounter();
-            break;
         default:
             break;
             
     }
 }
 
+// map a key to the lander input it drives.  keys that don't fly the
+// lander still count as OtherKey since releasing them restarts the
+// thrust timer.
+//
+bool ofApp::controlForKey(int key, LanderControl &control) {
+    switch (key) {
+        case OF_KEY_UP: control = ThrustUp; break;
+        case OF_KEY_DOWN: control = ThrustDown; break;
+        case OF_KEY_LEFT: control = ThrustLeft; break;
+        case OF_KEY_RIGHT: control = ThrustRight; break;
+        case 'z': control = ThrustForward; break;
+        case 'x': control = ThrustBack; break;
+        case 'r': control = Restart; break;
+        case OF_KEY_F5:
+        case OF_KEY_F6:
+        case OF_KEY_F7:
+        case OF_KEY_F8:
+        case OF_KEY_F9:
+            return false;
+        default: control = OtherKey; break;
+    }
+    return true;
+}
+
+// F5 starts recording from the current state, pressing it again saves the
+// recording to bin/data/flight.rec
+//
+void ofApp::toggleRecording() {
+    LanderSim &sim = pipeline.acquire();
+    if (!recorder.recording) {
+        recorder.start(sim);
+        bReplayed = false;
+        return;
+    }
+    recorder.stop(sim);
+    if (recorder.save(ofToDataPath("flight.rec")))
+        cout << "saved flight: " << recorder.frames << " frames, " << recorder.events.size() << " inputs" << endl;
+    else cout << "Error: can't save flight.rec" << endl;
+}
+
+// F6 replays flight.rec headless in a separate sim, as fast as possible,
+// and reports the frame timing
+//
+void ofApp::replayRecording() {
+    if (recorder.recording) return;
+    if (!bCollisionReady) {
+        cout << "Error: terrain still loading" << endl;
+        return;
+    }
+    FlightRecorder flight;
+    if (!flight.load(ofToDataPath("flight.rec"))) {
+        cout << "Error: can't load flight.rec" << endl;
+        return;
+    }
+    LanderSim replay;
+    replay.setTerrain(&octrees, &terrain);
+    replayStats = replayFlight(replay, flight);
+    bReplayed = true;
+    cout << "replayed " << replayStats.frames << " frames in " << replayStats.totalMillis << " ms, max "
+         << replayStats.maxFrameMillis << " ms, landed at " << toOf(replayStats.finalPosition)
+         << ", trajectory " << std::hex << replayStats.trajectoryHash << std::dec << endl;
+}
+
 
 
 //--------------------------------------------------------------
@@ -528,8 +745,8 @@ void ofApp::mousePressed(int x, int y, int button) {
         ofVec3f min = lander.getSceneMin() + lander.getPosition();
         ofVec3f max = lander.getSceneMax() + lander.getPosition();
         
-        Box bounds = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
-        bool hit = bounds.intersect(Ray(Vector3(origin.x, origin.y, origin.z), Vector3(mouseDir.x, mouseDir.y, mouseDir.z)), 0, 10000);
+        Box bounds = Box(toSim(min), toSim(max));
+        bool hit = bounds.intersect(Ray(toSim(origin), toSim(mouseDir)), 0, 10000);
         if (hit) {
             bLanderSelected = true;
             mouseDownPos = getMousePointOnPlane(lander.getPosition(), cam.getZAxis());
@@ -551,13 +768,12 @@ bool ofApp::raySelectWithOctree(ofVec3f &pointRet) {
     ofVec3f rayPoint = cam.screenToWorld(mouse);
     ofVec3f rayDir = rayPoint - cam.getPosition();
     rayDir.normalize();
-    Ray ray = Ray(Vector3(rayPoint.x, rayPoint.y, rayPoint.z),
-                  Vector3(rayDir.x, rayDir.y, rayDir.z));
+    Ray ray = Ray(toSim(rayPoint), toSim(rayDir));
     
-    pointSelected = octree.intersect(ray, octree.root, selectedNode);
+    pointSelected = octree.intersect(ray, octree.root, selectedNode) && !selectedNode.points.empty();
     
     if (pointSelected) {
-        pointRet = octree.mesh.getVertex(selectedNode.points[0]);
+        pointRet = toOf(octree.mesh->getVertex(selectedNode.points[0]));
     }
     return pointSelected;
 }
@@ -586,7 +802,7 @@ void ofApp::mouseDragged(int x, int y, int button) {
         ofVec3f min = lander.getSceneMin() + lander.getPosition();
         ofVec3f max = lander.getSceneMax() + lander.getPosition();
         
-        Box bounds = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
+        Box bounds = Box(toSim(min), toSim(max));
         
         colBoxList.clear();
         octree.intersect(bounds, octree.root, colBoxList);
@@ -706,7 +922,7 @@ void ofApp::dragEvent2(ofDragInfo dragInfo) {
         
         bLanderLoaded = true;
         for (int i = 0; i < lander.getMeshCount(); i++) {
-            bboxList.push_back(Octree::meshBounds(lander.getMesh(i)));
+            bboxList.push_back(Octree::meshBounds(toSimMesh(lander.getMesh(i))));
         }
         
         cout << "Mesh Count: " << lander.getMeshCount() << endl;
@@ -735,7 +951,7 @@ void ofApp::dragEvent(ofDragInfo dragInfo) {
         cout << "number of meshes: " << lander.getNumMeshes() << endl;
         bboxList.clear();
         for (int i = 0; i < lander.getMeshCount(); i++) {
-            bboxList.push_back(Octree::meshBounds(lander.getMesh(i)));
+            bboxList.push_back(Octree::meshBounds(toSimMesh(lander.getMesh(i))));
         }
         
         //        lander.setRotation(1, 180, 1, 0, 0);
@@ -774,7 +990,7 @@ void ofApp::dragEvent(ofDragInfo dragInfo) {
             
             // set up bounding box for lander while we are at it
             //
-            landerBounds = Box(Vector3(min.x, min.y, min.z), Vector3(max.x, max.y, max.z));
+            landerBounds = Box(toSim(min), toSim(max));
         }
     }
     
@@ -813,22 +1029,3 @@ void ofApp::soundPlayer() {
     if (soundFileLoaded)
         noise.play();
 }
-
-// collision detection
-void ofApp::detectCollision() {
-    touchPoint = sys.particles[0].position+6;
-    ofVec3f velocity = sys.particles[0].velocity;
-    //cout<<velocity<<endl;
-    cout<<touchPoint<<endl;
-    if (octrees.intersect(touchPoint, octrees.root)) {
-        collided = true;
-        impulseForce.apply(1.5 * (-velocity * 2));
-    }
-    else{
-        collided = false;
-    }
-    
-    if (octrees.intersect(touchPoint, octrees.root) && velocity.y<-7){
-        impulseForce.apply(50 * (-velocity * 4));
-    }
-}
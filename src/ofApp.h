@@ -6,8 +6,20 @@
 #include "Octree.h"
 #include "ParticleSystem.h"
 #include "ParticleEmitter.h"
+#include "ParticleRenderer.h"
+#include "TerrainRenderer.h"
+#include "TerrainCollider.h"
+#include "LanderSim.h"
+#include "FlightRecorder.h"
+#include "SimPipeline.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include "TerrainLoader.h"
+#include "Lidar.h"
+#include "SimBridge.h"
 #include "ray.h"
 #include "box.h"
+#include <future>
 
 
 
@@ -17,6 +29,7 @@ public:
     void setup();
     void update();
     void draw();
+    void exit();
     
     void keyPressed(int key);
     void keyReleased(int key);
@@ -88,28 +101,64 @@ public:
     ofImage background;
     
     Octree octrees;
+    TerrainCollider terrain;
+    
+    // startup loading: the terrain chunks, tree and lighting are built and
+    // the background image decoded on other threads, the lander and sound
+    // are loaded one per frame
+    //
+    TerrainChunks terrainChunks;        // built by the loader, drawn in place of mars
+    TerrainRenderer terrainRenderer;
+    TerrainBake terrainBake;            // occlusion and sun shadow, cached next to the mesh
+    TerrainLoader terrainLoader;        // declared after all it fills, so it stops first
+    vector<ChunkDraw> terrainDraws;
+    bool bChunkedTerrain = true;        // F9 switches back to the full model
+    bool bTerrainModelLoaded = false;   // mars, loaded when first drawn
+    glm::mat4 terrainModel;             // terrain mesh space to world
+    ofPixels backgroundPixels;
+    std::future<bool> backgroundLoad;   // declared after the pixels it fills
+    int loadStep = 0;
+    bool bBackgroundLoaded = false;
+    bool bSceneReady = false;       // terrain shown, sim running
+    bool bCollisionReady = false;   // octree built and handed to the sim
+    bool bTerrainDone = false;      // loader finished, lighting applied
     
-    bool collided;
-    
-    void detectCollision();
     void soundPlayer();
-    
-    ofVec3f touchPoint;
-    
-    ImpulseForce impulseForce;
-    ParticleSystem sys;
-    ThrusterForce thrust;
-    ParticleEmitter engine;
-    Particle rocket;
+    void loadAssets();
+    void drawLoadingProgress();
+    void drawProfile();
+    void loadTerrainModel();
+    void drawTerrain();
+    void scanTerrain();
+    void drawLidar();
+    void exportTrace();
+    bool controlForKey(int key, LanderControl &control);
+    void toggleRecording();
+    void replayRecording();
+    
+    TelemetryRing telemetry;        // declared before sim, which logs to it
+    TelemetryWriter telemetryWriter;
+    SampledClock clock;             // the OF timer as the sim sees it, set each step
+    LanderSim sim;
+    SimPipeline pipeline{sim, &clock};  // steps sim while the last frame is drawn
+    FlightRecorder recorder;
+    ReplayStats replayStats;
+    bool bReplayed = false;
+    bool bShowProfile = false;      // F7, also switches the profiler on
+    
+    // hazard detection lidar, swept under the lander every frame while on (h)
+    //
+    Lidar lidar;
+    LidarPattern lidarPattern;
+    LidarScan lidarScan;
+    ofMesh lidarPoints;
+    bool bLidar = false;
+    ParticleRenderer exhaustRenderer;
+    uint64_t frameStartMicros = 0;
     
     ofSoundPlayer noise;
     
     bool soundFileLoaded = false;
-    bool gameOver = false;
-    
-    float thrustTime;
-    float fuel;
-    float altitudes;
     
     ofLight landing1, landing2, landing3, areaLight;
 };
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdio.h>
+#include <math.h>
+#include "Mesh.h"
+
+//  Checks for the headless core tests.  CHECK() reports a failed condition
+//  with its file and line and carries on, so one run lists every failure;
+//  each test's main() ends with checkResult(), whose exit status ctest
+//  reads.
+//
+inline int &checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            checkFailures()++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b, eps) \
+    do { \
+        double checkA = (a), checkB = (b); \
+        if (!(fabs(checkA - checkB) <= (eps))) { \
+            printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, checkA, checkB); \
+            checkFailures()++; \
+        } \
+    } while (0)
+
+inline int checkResult(const char *name) {
+    printf("%s: %s\n", name, checkFailures() ? "FAILED" : "ok");
+    return checkFailures() ? 1 : 0;
+}
+
+//  Synthetic terrain for the octree and terrain tests: an n x n grid of
+//  points spacing apart in x and z, two triangles per cell.  Rolling hills,
+//  a steep ridge a few cells wide across the middle and a fine ripple, so
+//  faces vary in slope and the ridge casts shadows and occludes.
+//
+inline float terrainHeight(int i, int j, int n) {
+    float h = 6 * sinf(i * .04f) * cosf(j * .03f) + .05f * sinf(i * 1.3f + j * .7f);
+    if (i > n * 48 / 100 && i < n * 52 / 100) h += 3;
+    return h;
+}
+
+inline void heightField(Mesh &mesh, int n, float spacing = .4f) {
+    mesh = Mesh();
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            mesh.vertices.push_back(Vec3(i * spacing, terrainHeight(i, j, n), j * spacing));
+    for (int j = 0; j < n - 1; j++) {
+        for (int i = 0; i < n - 1; i++) {
+            unsigned int a = j * n + i, b = a + 1, c = a + n, d = c + 1;
+            unsigned int quad[6] = { a, c, b, b, c, d };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+    }
+}
@@ -0,0 +1,333 @@
+#include "Check.h"
+#include "ParticleSystem.h"
+#include "ForceSet.h"
+#include "Integrator.h"
+#include "Octree.h"
+#include "Altimeter.h"
+#include "Lidar.h"
+#include "TerrainBake.h"
+#include "TerrainFile.h"
+#include "ObjLoader.h"
+#include "Random.h"
+#include "MeshSimplifier.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using namespace std;
+
+//  Timings of the core's hot paths, the numbers quoted when they were
+//  tuned.  Run with no arguments for every section or name the ones
+//  wanted:
+//
+//      core_bench raycast lidar
+//
+//  Absolute times depend on the machine; compare runs on the same one.
+//
+
+typedef chrono::steady_clock BenchClock;
+
+static double millisSince(BenchClock::time_point start) {
+    return chrono::duration<double, milli>(BenchClock::now() - start).count();
+}
+
+static const int GridSize = 250;
+static const float Spacing = .4f;
+
+static Mesh &terrain() {
+    static Mesh mesh;
+    if (mesh.vertices.empty()) heightField(mesh, GridSize, Spacing);
+    return mesh;
+}
+
+// a point wandering over the terrain near the surface, as the lander does
+//
+static Vec3 pathPoint(int f) {
+    float x = 50 + 40 * sinf(f * .001f), z = 50 + 30 * cosf(f * .0013f);
+    return Vec3(x, terrainHeight((int)(x / Spacing), (int)(z / Spacing), GridSize) + sinf(f * .03f), z);
+}
+
+// runtime force list against the same forces as a ForceSet
+//
+static void benchForces() {
+    for (int fused = 0; fused < 2; fused++) {
+        FixedClock clock;
+        ParticleSystem sys(100000);
+        sys.clock = &clock;
+        TurbulenceForce turbulence(Vec3(-2, -1, -3), Vec3(1, 2, 5));
+        CyclicForce cyclic(20);
+        GravityForce gravity;
+        ForceSet<TurbulenceForce, CyclicForce, GravityForce> set(turbulence, cyclic, gravity);
+        if (fused) sys.setForces(&set);
+        else {
+            sys.addForce(&turbulence);
+            sys.addForce(&cyclic);
+            sys.addForce(&gravity);
+        }
+        Particle p;
+        p.lifespan = -1;
+        for (int i = 0; i < 100000; i++) {
+            p.position.set(i % 300 * .1f, 1, i / 300 * .1f);
+            sys.add(p);
+        }
+        BenchClock::time_point start = BenchClock::now();
+        for (int f = 0; f < 200; f++) {
+            sys.update();
+            clock.advance();
+        }
+        printf("  %-10s %7.3f ms/update  (100k particles)\n", fused ? "ForceSet" : "list", millisSince(start) / 200);
+    }
+}
+
+// cost of one 60 fps frame with each integrator, and the substeps the
+// adaptive ones take
+//
+static void benchIntegrators() {
+    const char *names[] = { "Euler", "semi-Euler", "Verlet", "RK4" };
+    Vec3 force(.3f, -1.6f, .1f);
+    for (int adaptive = 0; adaptive < 2; adaptive++) {
+        for (int type = 0; type < 4; type++) {
+            Integrator in((IntegratorType)type);
+            in.adaptive = adaptive != 0;
+            Particle p;
+            p.velocity.set(1, 2, 0);
+            int substeps = 0, n = 200000;
+            BenchClock::time_point start = BenchClock::now();
+            for (int i = 0; i < n; i++) {
+                p.forces = force;
+                substeps += in.step(p, 1 / 60.0f);
+            }
+            printf("  %-10s %-8s %6.1f ns/step  %.2f substeps\n", names[type], adaptive ? "adaptive" : "fixed",
+                   millisSince(start) * 1e6 / n, (float)substeps / n);
+        }
+    }
+}
+
+// contact searched from the root against through a cursor that follows
+// the path, as the lander uses it
+//
+static void benchContact() {
+    Octree octree;
+    octree.create(terrain(), 8);
+    OctreeCursor cursor;
+    int n = 20000;
+    double plain = 0, cursored = 0;
+    for (int f = 0; f < n; f++) {
+        Vec3 p = pathPoint(f);
+        Contact a, b;
+        BenchClock::time_point start = BenchClock::now();
+        octree.contact(p, a);
+        plain += millisSince(start);
+        start = BenchClock::now();
+        octree.contact(p, b, cursor);
+        cursored += millisSince(start);
+    }
+    printf("  plain %.2f us  cursor %.2f us  (root descents %d of %d)\n", plain * 1000 / n, cursored * 1000 / n,
+           cursor.rootDescents, cursor.queries);
+}
+
+// contact on the full mesh against a simplified proxy of it
+//
+static void benchProxy() {
+    Octree full;
+    full.create(terrain(), 7);
+    float edges[] = { 0, .8f, 1.2f };
+    for (int e = 0; e < 3; e++) {
+        Mesh proxyMesh;
+        SimplifyStats stats;
+        BenchClock::time_point start = BenchClock::now();
+        simplifyMesh(terrain(), proxyMesh, .05f, edges[e], 0, &stats);
+        double simplify = millisSince(start);
+        Octree proxy;
+        proxy.create(proxyMesh, 7);
+        OctreeCursor a, b;
+        double fullMillis = 0, proxyMillis = 0;
+        float worst = 0;
+        int n = 20000;
+        for (int f = 0; f < n; f++) {
+            Vec3 p = pathPoint(f);
+            Contact x, y;
+            start = BenchClock::now();
+            full.contact(p, x, a);
+            fullMillis += millisSince(start);
+            start = BenchClock::now();
+            proxy.contact(p, y, b);
+            proxyMillis += millisSince(start);
+            if (x.hit && y.hit) worst = max(worst, fabsf(x.depth - y.depth));
+        }
+        printf("  edge %.1f: faces %d -> %d, deviation %.4f, %.0f ms; contact %.2f us -> %.2f us, depth diff %.4f\n",
+               edges[e], stats.sourceFaces, stats.faces, stats.maxDeviation, simplify, fullMillis * 1000 / n,
+               proxyMillis * 1000 / n, worst);
+    }
+}
+
+// one altimeter sample (a ray down and one along the velocity) from a
+// path 12 units up
+//
+static void benchAltimeter() {
+    Octree octree;
+    octree.create(terrain(), 7);
+    Altimeter altimeter;
+    int n = 20000;
+    float sink = 0;
+    BenchClock::time_point start = BenchClock::now();
+    for (int i = 0; i < n; i++) {
+        Vec3 p(50 + 40 * sinf(i * .001f), 12, 50 + 30 * cosf(i * .0013f));
+        altimeter.measure(octree, p, Vec3(.3f, -1, .2f));
+        sink += altimeter.agl;
+    }
+    printf("  %.2f us/measure (2 rays)  [%g]\n", millisSince(start) * 1000 / n, sink);
+}
+
+// one 128 x 128 sweep cast in prepared (Morton) order, row order and
+// shuffled, serially and over the shared pool
+//
+static void benchLidar() {
+    Octree octree;
+    octree.create(terrain(), 7);
+    LidarPattern pattern;
+    pattern.grid(1.2f, 1.2f, 128, 128);
+    LidarPattern rows = pattern, shuffled = pattern;
+    rows.order.clear();
+    SquaresRandom random(1);
+    for (int i = shuffled.order.size() - 1; i > 0; i--)
+        swap(shuffled.order[i], shuffled.order[min(i, (int)(random.uniform(0, 1) * (i + 1)))]);
+    Lidar lidar;
+    lidar.setPose(Vec3(50, 25, 50), Vec3(.2f, -1, .1f).getNormalized(), Vec3(0, 0, 1));
+    lidar.pool = NULL;
+    LidarScan scan;
+    const char *names[] = { "morton", "rows", "shuffled" };
+    const LidarPattern *patterns[] = { &pattern, &rows, &shuffled };
+    for (int i = 0; i < 3; i++) {
+        lidar.scan(octree, *patterns[i], scan);
+        printf("  serial %-9s %6.2f ms  %.2f Mrays/s\n", names[i], scan.millis, scan.raysPerSecond() / 1e6);
+    }
+    lidar.pool = &ThreadPool::shared();
+    lidar.scan(octree, pattern, scan);
+    printf("  pool   %-9s %6.2f ms  %.2f Mrays/s on %d threads\n", names[0], scan.millis, scan.raysPerSecond() / 1e6,
+           scan.threads);
+}
+
+// ray cost by tree depth
+//
+static void benchRaycast() {
+    SquaresRandom random(3);
+    int n = 20000;
+    vector<Vec3> origins(n), dirs(n);
+    float extent = (GridSize - 1) * Spacing;
+    for (int i = 0; i < n; i++) {
+        origins[i].set(random.uniform(0, extent), random.uniform(10, 30), random.uniform(0, extent));
+        dirs[i] = Vec3(random.uniform(-.5f, .5f), -random.uniform(.05f, 1), random.uniform(-.5f, .5f)).getNormalized();
+    }
+    for (int levels = 5; levels <= 9; levels++) {
+        Octree octree;
+        octree.create(terrain(), levels);
+        int hits = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int i = 0; i < n; i++) {
+            RayHit hit;
+            hits += octree.raycast(origins[i], dirs[i], 1000, hit);
+        }
+        printf("  levels %d: %.2f us/ray  (%d hits)\n", levels, millisSince(start) * 1000 / n, hits);
+    }
+}
+
+// bake time at two grid resolutions, on every core
+//
+static void benchBake() {
+    Octree octree;
+    octree.create(terrain(), 7);
+    int resolutions[] = { 256, 512 };
+    for (int r = 0; r < 2; r++) {
+        TerrainChunks grid;
+        grid.create(terrain(), resolutions[r]);
+        TerrainBake bake;
+        bake.bake(octree, grid);
+        printf("  grid %dx%d: %.0f ms\n", grid.nx, grid.nz, bake.millis);
+    }
+}
+
+// parsing the OBJ against mapping the binary terrain file
+//
+static void benchLoad() {
+    Mesh big;
+    heightField(big, 700);
+    FILE *fp = fopen("bench.obj", "w");
+    if (fp == NULL) return;
+    for (int i = 0; i < big.vertices.size(); i++)
+        fprintf(fp, "v %f %f %f\n", big.vertices[i].x, big.vertices[i].y, big.vertices[i].z);
+    for (int f = 0; f < big.getNumFaces(); f++)
+        fprintf(fp, "f %u %u %u\n", big.indices[f * 3] + 1, big.indices[f * 3 + 1] + 1, big.indices[f * 3 + 2] + 1);
+    fclose(fp);
+    Mesh mesh;
+    BenchClock::time_point start = BenchClock::now();
+    loadObj("bench.obj", mesh);
+    double obj = millisSince(start);
+    saveTerrainFile("bench.obj.mesh", mesh, "bench.obj");
+    start = BenchClock::now();
+    loadTerrainFile("bench.obj.mesh", mesh, "bench.obj");
+    printf("  %d faces: obj %.1f ms  binary %.1f ms\n", mesh.getNumFaces(), obj, millisSince(start));
+    remove("bench.obj");
+    remove("bench.obj.mesh");
+}
+
+static int countNodes(const TreeNode &node) {
+    int n = 1;
+    for (int i = 0; i < node.children.size(); i++) n += countNodes(node.children[i]);
+    return n;
+}
+
+// build time of an eager and a lazy tree over a 500 x 500 field
+//
+static void benchLazy() {
+    Mesh big;
+    heightField(big, 500);
+    shared_ptr<const Mesh> mesh = make_shared<const Mesh>(big);
+    for (int lazy = 0; lazy < 2; lazy++) {
+        Octree octree;
+        octree.bLazy = lazy != 0;
+        BenchClock::time_point start = BenchClock::now();
+        octree.create(mesh, 8);
+        printf("  %-5s create %.1f ms, %d nodes\n", lazy ? "lazy" : "eager", millisSince(start), countNodes(octree.root));
+    }
+}
+
+struct Bench {
+    const char *name;
+    void (*run)();
+};
+
+static const Bench benches[] = {
+    { "forces", benchForces },
+    { "integrators", benchIntegrators },
+    { "contact", benchContact },
+    { "proxy", benchProxy },
+    { "altimeter", benchAltimeter },
+    { "lidar", benchLidar },
+    { "raycast", benchRaycast },
+    { "bake", benchBake },
+    { "load", benchLoad },
+    { "lazy", benchLazy },
+};
+
+int main(int argc, char **argv) {
+    int count = sizeof(benches) / sizeof(benches[0]), ran = 0;
+    for (int i = 0; i < count; i++) {
+        bool wanted = argc < 2;
+        for (int a = 1; a < argc; a++) wanted = wanted || strcmp(argv[a], benches[i].name) == 0;
+        if (!wanted) continue;
+        printf("%s\n", benches[i].name);
+        benches[i].run();
+        ran++;
+    }
+    if (ran == 0) {
+        printf("sections:");
+        for (int i = 0; i < count; i++) printf(" %s", benches[i].name);
+        printf("\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,331 @@
+#include "Check.h"
+#include "Octree.h"
+#include "Altimeter.h"
+#include "Lidar.h"
+#include "MeshSimplifier.h"
+#include "Triangle.h"
+#include "Random.h"
+#include <math.h>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+static const int GridSize = 150;
+static const float Spacing = .4f;
+
+// random points over the terrain, some above and some below the surface
+//
+static Vec3 randomPoint(SquaresRandom &random, float below, float above) {
+    float extent = (GridSize - 1) * Spacing;
+    return Vec3(random.uniform(0, extent), random.uniform(below, above), random.uniform(0, extent));
+}
+
+static Vec3 randomDown(SquaresRandom &random) {
+    Vec3 d(random.uniform(-.5f, .5f), -random.uniform(.05f, 1), random.uniform(-.5f, .5f));
+    return d.getNormalized();
+}
+
+// nearest hit over every face
+//
+static bool bruteRaycast(const Mesh &mesh, const Vec3 &o, const Vec3 &d, float &best) {
+    best = 1e30f;
+    bool hit = false;
+    for (int f = 0; f < mesh.getNumFaces(); f++) {
+        float t;
+        if (rayTriangle(o, d, mesh.getFaceVertex(f, 0), mesh.getFaceVertex(f, 1), mesh.getFaceVertex(f, 2), t) &&
+            t < best) {
+            best = t;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+static void testRaycast(const Mesh &mesh, const Octree &octree) {
+    SquaresRandom random(3);
+    int bad = 0;
+    for (int i = 0; i < 200; i++) {
+        Vec3 o = randomPoint(random, 10, 30), d = randomDown(random);
+        RayHit hit;
+        octree.raycast(o, d, 1000, hit);
+        float best;
+        bool expected = bruteRaycast(mesh, o, d, best);
+        if (hit.hit != expected || (hit.hit && fabs(hit.distance - best) > 1e-3f)) bad++;
+    }
+    CHECK(bad == 0);
+
+    // nothing past the range
+    //
+    RayHit hit;
+    CHECK(!octree.raycast(Vec3(30, 40, 30), Vec3(0, -1, 0), 5, hit));
+}
+
+// points just above and below the surface, in leaves that hold terrain:
+// the contact has the sign of the offset, lies on its triangle and faces
+// up
+//
+static void testContact(const Mesh &mesh, const Octree &octree) {
+    SquaresRandom random(11);
+    int bad = 0, hits = 0;
+    for (int k = 0; k < 500; k++) {
+        int i = 5 + (int)random.uniform(0, 60), j = 5 + (int)random.uniform(0, 140);
+        float offset = k % 2 ? .2f : -.2f;
+        Vec3 p(i * Spacing, terrainHeight(i, j, GridSize) - offset, j * Spacing);
+        Contact contact;
+        if (!octree.contact(p, contact)) continue;
+        hits++;
+        if (contact.triangle < 0 || contact.triangle >= mesh.getNumFaces()) {
+            bad++;
+            continue;
+        }
+        const Vec3 &a = mesh.getFaceVertex(contact.triangle, 0);
+        if ((contact.depth > 0) != (offset > 0) || fabsf(contact.depth) > .2f + 1e-4f) bad++;
+        if (contact.normal.y < .5f || fabsf((contact.point - a).dot(contact.normal)) > 1e-3f) bad++;
+        if (contact.point.distance(p) > .2f + 1e-4f) bad++;
+    }
+    CHECK(bad == 0);
+    CHECK(hits > 200);
+
+    // far above the terrain the point's leaf holds no terrain
+    //
+    Contact contact;
+    octree.contact(Vec3(30, 200, 30), contact);
+    CHECK(!contact.hit);
+}
+
+// queries through a cursor answer the same as from the root, following a
+// path and after far jumps
+//
+static void testCursor(const Octree &octree) {
+    OctreeCursor cursor;
+    SquaresRandom random(5);
+    int bad = 0;
+    for (int f = 0; f < 4000; f++) {
+        Vec3 p;
+        if (f < 3000) {
+            float t = f * .01f;
+            p.set(30 + 25 * sinf(t * .3f), 2 * sinf(t * 3), 30 + 20 * cosf(t * .2f));
+        }
+        else p = randomPoint(random, -6, 8);
+        Contact a, b;
+        octree.contact(p, a);
+        octree.contact(p, b, cursor);
+        if (a.hit != b.hit || (a.hit && (a.triangle != b.triangle || fabs(a.depth - b.depth) > 1e-5f))) bad++;
+        if (octree.findLeaf(p) != octree.findLeaf(p, cursor)) bad++;
+    }
+    CHECK(bad == 0);
+    CHECK(cursor.rootDescents < cursor.queries);
+}
+
+// a lazy tree, expanded by queries as they come, answers like an eager
+// one; so do a copy of it and a tree deepened with setLevels()
+//
+static void testLazy(shared_ptr<const Mesh> mesh, const Octree &eager) {
+    Octree lazy;
+    lazy.bLazy = true;
+    lazy.create(mesh, eager.getLevels());
+    Octree deepened;
+    deepened.create(mesh, eager.getLevels() - 2);
+    deepened.setLevels(eager.getLevels());
+
+    SquaresRandom random(9);
+    int bad = 0;
+    for (int i = 0; i < 2000; i++) {
+        Vec3 o = randomPoint(random, 10, 30), d = randomDown(random);
+        RayHit a, b, c;
+        eager.raycast(o, d, 1000, a);
+        lazy.raycast(o, d, 1000, b);
+        deepened.raycast(o, d, 1000, c);
+        if (a.hit != b.hit || a.triangle != b.triangle || a.triangle != c.triangle) bad++;
+
+        Vec3 p = randomPoint(random, -6, 8);
+        Contact x, y;
+        eager.contact(p, x);
+        lazy.contact(p, y);
+        if (x.hit != y.hit || x.triangle != y.triangle) bad++;
+        const TreeNode *u = eager.findLeaf(p), *v = lazy.findLeaf(p);
+        if ((u == NULL) != (v == NULL) || (u && u->box.min() != v->box.min())) bad++;
+    }
+    CHECK(bad == 0);
+
+    // a copy has its own lock and goes on expanding by itself
+    //
+    Octree copy = lazy;
+    int differ = 0;
+    for (int i = 0; i < 200; i++) {
+        Vec3 o = randomPoint(random, 10, 30), d = randomDown(random);
+        RayHit a, b;
+        eager.raycast(o, d, 1000, a);
+        copy.raycast(o, d, 1000, b);
+        if (a.hit != b.hit || a.triangle != b.triangle) differ++;
+    }
+    CHECK(differ == 0);
+}
+
+// above a grid point the altimeter reads the clearance to it
+//
+static void testAltimeter(const Octree &octree) {
+    Altimeter altimeter;
+    int i = 100, j = 100;
+    Vec3 p(i * Spacing, terrainHeight(i, j, GridSize) + 12, j * Spacing);
+    CHECK(altimeter.measure(octree, p, Vec3(0, -2, 0)));
+    CHECK(altimeter.valid);
+    CHECK_NEAR(altimeter.agl, 12, 1e-3);
+    CHECK_NEAR(altimeter.timeToImpact, 6, 1e-2);
+    CHECK(altimeter.normal.y > .5f);
+
+    // climbing away is no impact
+    //
+    altimeter.measure(octree, p, Vec3(0, 2, 0));
+    CHECK(altimeter.timeToImpact < 0);
+}
+
+// a sweep shared out over the pool matches the serial one exactly
+//
+static void testLidar(const Octree &octree) {
+    LidarPattern pattern;
+    pattern.grid(1.2f, 1.2f, 64, 64);
+    Lidar lidar;
+    lidar.setPose(Vec3(30, 25, 30), Vec3(.2f, -1, .1f).getNormalized(), Vec3(0, 0, 1));
+    ThreadPool pool(3);
+    LidarScan pooled, serial;
+    lidar.pool = &pool;
+    lidar.scan(octree, pattern, pooled);
+    lidar.pool = NULL;
+    lidar.scan(octree, pattern, serial);
+    CHECK(pooled.distances.size() == 64 * 64);
+    CHECK(pooled.distances == serial.distances);
+    CHECK(serial.returns > 0);
+}
+
+// the simplified proxy stays within its error bound of the full mesh,
+// and the reported deviation covers both directions
+//
+static void testProxy(const Mesh &mesh) {
+    Mesh proxy;
+    SimplifyStats stats;
+    CHECK(simplifyMesh(mesh, proxy, .05f, 1.2f, 0, &stats));
+    CHECK(stats.faces < stats.sourceFaces);
+    CHECK(stats.maxDeviation <= .05f + 1e-4f);
+    CHECK(meshDeviation(mesh, proxy) <= stats.maxDeviation);
+    CHECK(meshDeviation(proxy, mesh) <= stats.maxDeviation);
+}
+
+// ray against box with every axis worked out separately, in doubles
+//
+static bool slabReference(const Box &box, const Vec3 &o, const Vec3 &d, float t0, float t1) {
+    Vec3 lo = box.min(), hi = box.max();
+    double tmin = -1e300, tmax = 1e300;
+    for (int axis = 0; axis < 3; axis++) {
+        if (d[axis] == 0) {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+            continue;
+        }
+        double a = (lo[axis] - o[axis]) / (double)d[axis], b = (hi[axis] - o[axis]) / (double)d[axis];
+        tmin = max(tmin, min(a, b));
+        tmax = min(tmax, max(a, b));
+    }
+    return tmin <= tmax && tmin < t1 && tmax > t0;
+}
+
+static void collectLeaves(const TreeNode &node, const Box &query, vector<Box> &leaves) {
+    bool overlaps = true;
+    for (int axis = 0; axis < 3; axis++)
+        overlaps = overlaps && node.box.min()[axis] <= query.max()[axis] && query.min()[axis] <= node.box.max()[axis];
+    if (!overlaps) return;
+    if (node.children.empty()) leaves.push_back(node.box);
+    for (int i = 0; i < node.children.size(); i++) collectLeaves(node.children[i], query, leaves);
+}
+
+// Box runs on four wide corners: inside() and overlap() are closed on every
+// face and the ray test matches a per axis one, straight down included;
+// box queries and subdivision through the octree agree with them
+//
+static void testBox(Octree &octree) {
+    SquaresRandom random(13);
+    int bad = 0;
+    for (int k = 0; k < 2000; k++) {
+        Vec3 a(random.uniform(-5, 5), random.uniform(-5, 5), random.uniform(-5, 5));
+        Box box(a, a + Vec3(random.uniform(.1f, 3), random.uniform(.1f, 3), random.uniform(.1f, 3)));
+        Vec3 lo = box.min(), hi = box.max();
+        Vec3 p(random.uniform(-6, 6), random.uniform(-6, 6), random.uniform(-6, 6));
+        bool inside = p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y && p.z >= lo.z && p.z <= hi.z;
+        if (box.inside(p) != inside) bad++;
+        if (!box.inside(Vec3(hi.x, lo.y, (lo.z + hi.z) / 2))) bad++;
+
+        Vec3 b(random.uniform(-5, 5), random.uniform(-5, 5), random.uniform(-5, 5));
+        Box other(b, b + Vec3(2, 2, 2));
+        bool overlap = true;
+        for (int axis = 0; axis < 3; axis++)
+            overlap = overlap && lo[axis] <= other.max()[axis] && other.min()[axis] <= hi[axis];
+        if (box.overlap(other) != overlap) bad++;
+        if (!box.overlap(Box(hi, hi + Vec3(1, 1, 1)))) bad++;
+
+        Vec3 o(random.uniform(-8, 8), random.uniform(-8, 8), random.uniform(-8, 8));
+        Vec3 d = k % 4 ? randomDown(random) : Vec3(0, -1, 0);
+        if (box.intersect(Ray(o, d), 0, 1000) != slabReference(box, o, d, 0, 1000)) bad++;
+    }
+    CHECK(bad == 0);
+    CHECK(Box(Vec3(1, 2, 3), Vec3(3, 6, 9)).center() == Vec3(2, 4, 6));
+
+    Box query(Vec3(10, -20, 10), Vec3(14, 20, 13));
+    vector<Box> found, expected;
+    octree.intersect(query, octree.root, found);
+    collectLeaves(octree.root, query, expected);
+    CHECK(!found.empty() && found.size() == expected.size());
+
+    vector<Box> eighths;
+    octree.subDivideBox8(octree.root.box, eighths);
+    float volume = 0;
+    int outside = 0;
+    for (int i = 0; i < eighths.size(); i++) {
+        Vec3 size = eighths[i].max() - eighths[i].min();
+        volume += size.x * size.y * size.z;
+        if (!octree.root.box.inside(eighths[i].center())) outside++;
+    }
+    Vec3 size = octree.root.box.max() - octree.root.box.min();
+    CHECK(eighths.size() == 8 && outside == 0);
+    CHECK_NEAR(volume, size.x * size.y * size.z, size.x * size.y * size.z * 1e-4);
+}
+
+// an empty box sits at the origin; a tree that was never built hits
+// nothing, and building it again replaces the old tree instead of adding
+// to it
+//
+static void testUnbuilt(const Mesh &mesh) {
+    Box box;
+    CHECK(box.min() == Vec3() && box.max() == Vec3());
+    Octree octree;
+    TreeNode node;
+    CHECK(!octree.intersect(Ray(Vec3(0, 10, 0), Vec3(0, -1, 0)), octree.root, node));
+    RayHit hit;
+    CHECK(!octree.raycast(Vec3(30, 40, 30), Vec3(0, -1, 0), 100, hit));
+    Contact contact;
+    CHECK(!octree.contact(Vec3(30, 0, 30), contact));
+
+    octree.create(mesh, 5);
+    size_t points = octree.root.points.size(), children = octree.root.children.size();
+    octree.create(mesh, 5);
+    CHECK(octree.root.points.size() == points && octree.root.children.size() == children);
+    CHECK(octree.raycast(Vec3(30, 40, 30), Vec3(0, -1, 0), 100, hit));
+}
+
+int main() {
+    Mesh mesh;
+    heightField(mesh, GridSize, Spacing);
+    shared_ptr<const Mesh> shared = make_shared<const Mesh>(mesh);
+    Octree octree;
+    octree.create(shared, 7);
+
+    testContact(mesh, octree);
+    testRaycast(mesh, octree);
+    testCursor(octree);
+    testLazy(shared, octree);
+    testAltimeter(octree);
+    testLidar(octree);
+    testProxy(mesh);
+    testBox(octree);
+    testUnbuilt(mesh);
+    return checkResult("OctreeTests");
+}
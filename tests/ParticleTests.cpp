@@ -0,0 +1,317 @@
+#include "Check.h"
+#include "ParticleSystem.h"
+#include "ParticleEmitter.h"
+#include "ParticleGrid.h"
+#include "ParticleBudget.h"
+#include "ForceSet.h"
+#include "Integrator.h"
+#include "Random.h"
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+// a system is uncapped unless a capacity is set; a capped pool never
+// grows past it, allocate() grants what fits, and setting 0 lifts the cap
+//
+static void testCapacity() {
+    ParticleSystem open;
+    Particle p;
+    for (int i = 0; i < 10000; i++) open.add(p);
+    CHECK(open.particles.size() == 10000);
+    CHECK(open.allocate(5000) == 10000);
+    CHECK(open.particles.size() == 15000);
+
+    ParticleSystem capped(100);
+    for (int i = 0; i < 150; i++) capped.add(p);
+    CHECK(capped.particles.size() == 100);
+    CHECK(capped.allocate(10) == 100);
+    CHECK(capped.particles.size() == 100);
+    capped.setCapacity(0);
+    capped.allocate(10);
+    CHECK(capped.particles.size() == 110);
+
+    ParticleSystem sys(100);
+    CHECK(sys.allocate(60) == 0);
+    CHECK(sys.allocate(60) == 60);
+    CHECK(sys.particles.size() == 100);
+}
+
+// a batch fills its slots in place, each with the emitter's settings
+//
+static void testEmitter() {
+    FixedClock clock;
+    ParticleSystem sys(4096);
+    sys.clock = &clock;
+    ParticleEmitter emitter(&sys);
+    emitter.setEmitterType(RadialEmitter);
+    emitter.setLifespan(2);
+    emitter.spawnBatch(500, 300);
+    CHECK(sys.particles.size() == 300);
+    int bad = 0;
+    for (int i = 0; i < sys.particles.size(); i++) {
+        const Particle &q = sys.particles[i];
+        if (q.birthtime != 500 || q.lifespan != 2 || q.velocity.length() == 0) bad++;
+    }
+    CHECK(bad == 0);
+}
+
+// a seed reproduces every value, streams differ, fill() matches uniform()
+//
+static void testRandom() {
+    SquaresRandom a(42), b(42), c(43), s(42, 1);
+    int same = 0, differ = 0, streams = 0;
+    for (int i = 0; i < 1000; i++) {
+        float x = a.uniform(0, 1), y = b.uniform(0, 1), z = c.uniform(0, 1), w = s.uniform(0, 1);
+        same += x == y;
+        differ += x != z;
+        streams += x != w;
+    }
+    CHECK(same == 1000);
+    CHECK(differ > 990 && streams > 990);
+
+    SquaresRandom one(7), block(7);
+    float values[256];
+    block.fill(values, 256, -3, 5);
+    int bad = 0;
+    double sum = 0;
+    for (int i = 0; i < 256; i++) {
+        if (values[i] != one.uniform(-3, 5)) bad++;
+        if (values[i] < -3 || values[i] >= 5) bad++;
+        sum += values[i];
+    }
+    CHECK(bad == 0);
+    CHECK_NEAR(sum / 256, 1, .5);
+    CHECK(block.uniform(0, 1) == one.uniform(0, 1));
+}
+
+// serials follow spawn order and stay with their particles when others go
+//
+static void testSerials() {
+    ParticleSystem sys;
+    Particle p;
+    for (int i = 0; i < 5; i++) sys.add(p);
+    int first = sys.allocate(3);
+    CHECK(first == 5);
+    for (int i = 0; i < 8; i++) CHECK(sys.particles[i].serial == (unsigned)i);
+    sys.remove(2);
+    CHECK(sys.particles[2].serial == 3);
+    sys.add(p);
+    CHECK(sys.particles.back().serial == 8);
+}
+
+// a ForceSet applies the same deterministic forces as the runtime list
+//
+static void testForceSet() {
+    FixedClock clock;
+    ParticleSystem a, b;
+    a.clock = b.clock = &clock;
+    CyclicForce cyclic(20);
+    GravityForce gravity;
+    a.addForce(&cyclic);
+    a.addForce(&gravity);
+    ForceSet<CyclicForce, GravityForce> set(cyclic, gravity);
+    b.setForces(&set);
+    Particle p;
+    p.lifespan = -1;
+    for (int i = 0; i < 100; i++) {
+        p.position.set(i * .1f, 1, 2);
+        a.add(p);
+        b.add(p);
+    }
+    for (int f = 0; f < 50; f++) {
+        a.update();
+        b.update();
+        clock.advance();
+    }
+    float worst = 0;
+    for (int i = 0; i < 100; i++)
+        worst = max(worst, a.particles[i].position.distance(b.particles[i].position));
+    CHECK(worst < 1e-5f);
+
+    // one shot forces in a set fire once
+    //
+    ImpulseForce impulse;
+    impulse.apply(Vec3(0, 600, 0));
+    ForceSet<ImpulseForce> kick(impulse);
+    ParticleSystem c;
+    c.clock = &clock;
+    c.setForces(&kick);
+    p.position.set(0, 0, 0);
+    c.add(p);
+    c.update();
+    float v = c.particles[0].velocity.y;
+    c.update();
+    CHECK(v > 0);
+    CHECK(c.particles[0].velocity.y < v);
+}
+
+// position after t seconds of constant acceleration a with drag k
+//
+static Vec3 closedForm(const Vec3 &x0, const Vec3 &v0, const Vec3 &a, float k, float t) {
+    if (k == 0) return x0 + v0 * t + a * (t * t / 2);
+    Vec3 terminal = a / k;
+    return x0 + terminal * t + (v0 - terminal) * ((1 - expf(-k * t)) / k);
+}
+
+// frames of constant force at the given rate, from rest at the origin
+// with velocity v0
+//
+static Vec3 integrate(Integrator &in, const Vec3 &v0, const Vec3 &force, float damping, float rate, int frames) {
+    Particle p;
+    p.velocity = v0;
+    p.damping = damping;
+    for (int f = 0; f < frames; f++) {
+        p.forces = force;
+        in.step(p, 1 / rate);
+    }
+    return p.position;
+}
+
+static void testIntegrators() {
+    Vec3 force(.3f, -1.6f, .1f), v0(1, 2, 0);
+
+    // constant force, no drag, 5 s at 60 fps: Verlet and RK4 are exact,
+    // the Euler variants first order
+    //
+    for (int type = 0; type < 4; type++) {
+        Integrator in((IntegratorType)type);
+        float error = integrate(in, v0, force, 1, 60, 300).distance(closedForm(Vec3(), v0, force, 0, 5));
+        if (type == VerletIntegrator || type == RK4Integrator) CHECK(error < 1e-3f);
+        else CHECK(error < .2f);
+    }
+
+    // strong drag at 15 fps: adaptive substeps bring Verlet close to a
+    // fine RK4 reference
+    //
+    Integrator reference(RK4Integrator);
+    Vec3 expected = integrate(reference, v0, force, .9f, 3840, 3840 * 2);
+    Integrator verlet(VerletIntegrator);
+    float fixedError = integrate(verlet, v0, force, .9f, 15, 30).distance(expected);
+    verlet.adaptive = true;
+    verlet.tolerance = .0005f;
+    float adaptiveError = integrate(verlet, v0, force, .9f, 15, 30).distance(expected);
+    CHECK(adaptiveError < fixedError / 4);
+    CHECK(adaptiveError < .005f);
+
+    // with drag, one long frame: adaptive Verlet and RK4 stay within the
+    // tolerance of the closed form
+    //
+    for (int type = VerletIntegrator; type <= RK4Integrator; type++) {
+        Integrator in((IntegratorType)type);
+        in.adaptive = true;
+        in.tolerance = .0005f;
+        Particle p;
+        p.velocity = v0;
+        p.damping = .99f;
+        p.forces = force;
+        in.step(p, .25f);
+        float k = -logf(p.damping) * Integrator::DampingRate;
+        CHECK(p.position.distance(closedForm(Vec3(), v0, force, k, .25f)) < in.tolerance);
+    }
+
+    // adaptive Euler that needs no refining is exactly the fixed step
+    //
+    Integrator euler(EulerIntegrator);
+    euler.adaptive = true;
+    euler.tolerance = 1;
+    Particle p, q;
+    p.velocity = q.velocity = v0;
+    p.forces = q.forces = force;
+    CHECK(euler.step(p, 1 / 60.0f) == 1);
+    q.integrate(1 / 60.0f);
+    CHECK(p.position == q.position && p.velocity == q.velocity);
+}
+
+// the catch-up factor matches the velocity each integrator leaves after
+// the same frames with no force (semi-implicit Euler's drag is first
+// order, so only to within its step error)
+//
+static void testDecay() {
+    for (int type = 0; type < 4; type++) {
+        Integrator in((IntegratorType)type);
+        Particle p;
+        p.velocity.set(1, 0, 0);
+        p.damping = .9f;
+        float expected = in.decay(p, 1 / 60.0f, 8);
+        for (int f = 0; f < 8; f++) in.step(p, 1 / 60.0f);
+        CHECK_NEAR(p.velocity.x, expected, type == SemiImplicitEulerIntegrator ? .025 : 1e-3);
+    }
+}
+
+// the budget sheds load over target and recovers with headroom; under
+// load a capped system only grants its share of the capacity
+//
+static void testBudget() {
+    ParticleBudget budget(12);
+    for (int f = 0; f < 100; f++) budget.frame(25);
+    CHECK(budget.level < .8f);
+    CHECK(budget.slices() > 1);
+    CHECK(budget.cap(1000) < 1000);
+
+    ParticleSystem sys(1000);
+    sys.budget = &budget;
+    sys.allocate(1000);
+    CHECK(sys.particles.size() == budget.cap(1000));
+    ParticleSystem open;
+    open.budget = &budget;
+    open.allocate(1000);
+    CHECK(open.particles.size() == 1000);
+
+    for (int f = 0; f < 400; f++) budget.frame(5);
+    CHECK(budget.level == 1);
+    CHECK(budget.slices() == 1);
+    sys.allocate(1000);
+    CHECK(sys.particles.size() == 1000);
+}
+
+// grid neighbor queries and removeNear() match a brute force search
+//
+static void testGrid() {
+    SquaresRandom random(7);
+    vector<Particle> particles(2000);
+    for (int i = 0; i < particles.size(); i++)
+        particles[i].position.set(random.uniform(-10, 10), random.uniform(-10, 10), random.uniform(-10, 10));
+    ParticleGrid grid;
+    grid.build(particles, 1.5f);
+    int bad = 0;
+    for (int q = 0; q < 50; q++) {
+        Vec3 point(random.uniform(-10, 10), random.uniform(-10, 10), random.uniform(-10, 10));
+        vector<int> found;
+        grid.query(point, 2, found);
+        vector<int> expected;
+        for (int i = 0; i < particles.size(); i++)
+            if (particles[i].position.squareDistance(point) <= 4) expected.push_back(i);
+        sort(found.begin(), found.end());
+        if (found != expected) bad++;
+    }
+    CHECK(bad == 0);
+
+    FixedClock clock;
+    ParticleSystem gridded(4096), scanned(4096);
+    gridded.clock = scanned.clock = &clock;
+    gridded.gridCellSize = 1.5f;
+    for (int i = 0; i < particles.size(); i++) {
+        particles[i].lifespan = -1;
+        gridded.add(particles[i]);
+        scanned.add(particles[i]);
+    }
+    gridded.update();
+    scanned.update();
+    Vec3 point(1, 2, 3);
+    CHECK(gridded.removeNear(point, 4) == scanned.removeNear(point, 4));
+    CHECK(gridded.particles.size() == scanned.particles.size());
+}
+
+int main() {
+    testCapacity();
+    testSerials();
+    testEmitter();
+    testRandom();
+    testBudget();
+    testForceSet();
+    testIntegrators();
+    testDecay();
+    testGrid();
+    return checkResult("ParticleTests");
+}
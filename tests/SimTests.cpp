@@ -0,0 +1,176 @@
+#include "Check.h"
+#include "LanderSim.h"
+#include "FlightRecorder.h"
+#include "SimPipeline.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include <string.h>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+// a flight with a few inputs, recorded as it is flown
+//
+static void fly(LanderSim &sim, FlightRecorder &rec, int frames) {
+    rec.start(sim);
+    for (int f = 0; f < frames; f++) {
+        if (f == 10) sim.press(ThrustUp);
+        if (f == 100) sim.release(ThrustUp);
+        if (f == 150) sim.press(ThrustLeft);
+        if (f == 200) sim.release(ThrustLeft);
+        sim.update();
+    }
+    rec.stop(sim);
+}
+
+static string readFile(const string &path) {
+    ifstream in(path.c_str());
+    stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// a saved recording loads back as it was; a truncated one is rejected
+//
+static void testRecorder() {
+    LanderSim sim;
+    FlightRecorder rec;
+    fly(sim, rec, 300);
+    CHECK(rec.frames == 300);
+    CHECK(rec.events.size() == 4);
+    CHECK(rec.save("flight.rec"));
+
+    FlightRecorder loaded;
+    CHECK(loaded.load("flight.rec"));
+    CHECK(loaded.frames == rec.frames);
+    CHECK(loaded.events.size() == rec.events.size());
+    CHECK(loaded.initial.position == rec.initial.position);
+    CHECK(loaded.initial.seed == rec.initial.seed);
+
+    // an event count far past the events in the file
+    //
+    string text = readFile("flight.rec");
+    ostringstream counts, huge;
+    counts << rec.frames << " " << rec.events.size() << "\n";
+    huge << rec.frames << " 999999999\n";
+    size_t at = text.find(counts.str());
+    CHECK(at != string::npos);
+    if (at != string::npos) {
+        string bad = text;
+        bad.replace(at, counts.str().size(), huge.str());
+        ofstream("corrupt.rec") << bad;
+        FlightRecorder corrupt;
+        CHECK(!corrupt.load("corrupt.rec"));
+        CHECK(corrupt.events.empty());
+    }
+
+    // cut off in the middle of the events
+    //
+    ofstream("truncated.rec") << text.substr(0, text.size() - 6);
+    FlightRecorder truncated;
+    CHECK(!truncated.load("truncated.rec"));
+}
+
+// replaying a recording reproduces the live flight exactly
+//
+static void testReplay() {
+    LanderSim live;
+    FlightRecorder rec;
+    fly(live, rec, 300);
+    Vec3 end = live.lander().position;
+
+    LanderSim a, b;
+    ReplayStats first = replayFlight(a, rec);
+    ReplayStats second = replayFlight(b, rec);
+    CHECK(first.frames == 300);
+    CHECK(first.finalPosition == end);
+    CHECK(first.trajectoryHash == second.trajectoryHash);
+}
+
+// the pipelined sim lands on the same frames as stepping it inline, one
+// frame behind
+//
+static void testPipeline() {
+    LanderSim a, b;
+    SimPipeline pipelined(a), inlined(b);
+    pipelined.setPipelined(true);
+    inlined.setPipelined(false);
+    pipelined.acquire().setFixedStep(true);
+    inlined.acquire().setFixedStep(true);
+    for (int f = 0; f < 300; f++) {
+        if (f == 20) {
+            pipelined.acquire().press(ThrustUp);
+            inlined.acquire().press(ThrustUp);
+        }
+        if (f == 120) {
+            pipelined.acquire().release(ThrustUp);
+            inlined.acquire().release(ThrustUp);
+        }
+        pipelined.step(f * 1000 / 60.0f, 60);
+        inlined.step(f * 1000 / 60.0f, 60);
+    }
+    LanderSim &done = pipelined.acquire();
+    CHECK(done.frame == 300);
+    CHECK(done.lander().position == b.lander().position);
+    CHECK(pipelined.current().frame == inlined.current().frame - 1);
+}
+
+// every record pushed is either written or counted as dropped
+//
+static void testTelemetry() {
+    TelemetryRing ring(64);
+    TelemetryWriter writer;
+    CHECK(writer.start(ring, "telemetry.bin", TelemetryBinary));
+    TelemetryRecord record = TelemetryRecord();
+    int pushed = 0;
+    for (int i = 0; i < 20000; i++) {
+        record.frame = i;
+        if (ring.push(record)) pushed++;
+    }
+    writer.stop();
+    CHECK(writer.written == pushed);
+    CHECK(pushed + ring.dropped == 20000);
+    CHECK(ring.size() == 0);
+}
+
+// nested scopes report their depth and call counts
+//
+static void testProfiler() {
+    Profiler &profiler = Profiler::get();
+    profiler.setEnabled(true);
+    profiler.setThreadName("main");
+    for (int i = 0; i < 10; i++) {
+        PROFILE_SCOPE("outer");
+        for (int j = 0; j < 3; j++) {
+            PROFILE_SCOPE("inner");
+        }
+    }
+    profiler.collect();
+    vector<ProfileStats> stats = profiler.summary();
+    int outer = -1, inner = -1;
+    for (int i = 0; i < stats.size(); i++) {
+        if (strcmp(stats[i].name, "outer") == 0) outer = i;
+        if (strcmp(stats[i].name, "inner") == 0) inner = i;
+    }
+    CHECK(outer >= 0 && inner >= 0);
+    if (outer >= 0 && inner >= 0) {
+        CHECK(stats[outer].depth == 0 && stats[outer].calls == 10);
+        CHECK(stats[inner].depth == 1 && stats[inner].calls == 30);
+        CHECK(stats[inner].p50 <= stats[outer].p50);
+    }
+    CHECK(profiler.exportTrace("trace.json"));
+    CHECK(readFile("trace.json").find("\"inner\"") != string::npos);
+    profiler.setEnabled(false);
+}
+
+int main() {
+    SystemClock clock;
+    Clock::setDefault(&clock);
+    testRecorder();
+    testReplay();
+    testPipeline();
+    testTelemetry();
+    testProfiler();
+    return checkResult("SimTests");
+}
@@ -0,0 +1,334 @@
+#include "Check.h"
+#include "Octree.h"
+#include "TerrainChunks.h"
+#include "TerrainBake.h"
+#include "TerrainCollider.h"
+#include "TerrainFile.h"
+#include "TerrainLoader.h"
+#include "ObjLoader.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+static const int GridSize = 150;
+
+static bool writeObj(const string &path, const Mesh &mesh) {
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == NULL) return false;
+    for (int i = 0; i < mesh.vertices.size(); i++)
+        fprintf(fp, "v %f %f %f\n", mesh.vertices[i].x, mesh.vertices[i].y, mesh.vertices[i].z);
+    for (int f = 0; f < mesh.getNumFaces(); f++)
+        fprintf(fp, "f %u %u %u\n", mesh.indices[f * 3] + 1, mesh.indices[f * 3 + 1] + 1, mesh.indices[f * 3 + 2] + 1);
+    return fclose(fp) == 0;
+}
+
+// height of chunk c drawn at level l at border point (i, j), interpolated
+// along the edge between the points that level keeps
+//
+static float edgeHeight(const TerrainChunks &t, int c, int l, int i, int j) {
+    int s = 1 << l, k = t.chunkCells, n = k + 1;
+    const TerrainChunk &chunk = t.chunks[c];
+    if (j == 0 || j == k) {
+        int a = (i / s) * s, b = min(a + s, k);
+        float f = (float)(i - a) / s;
+        return chunk.vertices[j * n + a].y * (1 - f) + chunk.vertices[j * n + b].y * f;
+    }
+    int a = (j / s) * s, b = min(a + s, k);
+    float f = (float)(j - a) / s;
+    return chunk.vertices[a * n + i].y * (1 - f) + chunk.vertices[b * n + i].y * f;
+}
+
+// neighbors drawn at any two levels never open a gap their skirts don't
+// cover; the frustum drops every chunk behind the camera
+//
+static void testChunks(const TerrainChunks &t) {
+    CHECK(t.chunksX == 4 && t.chunksZ == 4);
+    int k = t.chunkCells, bad = 0;
+    for (int cz = 0; cz < t.chunksZ; cz++) {
+        for (int cx = 0; cx + 1 < t.chunksX; cx++) {
+            int a = cz * t.chunksX + cx, b = a + 1;
+            for (int la = 0; la < t.levels; la++)
+                for (int lb = 0; lb < t.levels; lb++)
+                    for (int j = 0; j <= k; j++) {
+                        float gap = fabs(edgeHeight(t, a, la, k, j) - edgeHeight(t, b, lb, 0, j));
+                        if (gap > t.chunks[a].skirtDepth + 1e-4f || gap > t.chunks[b].skirtDepth + 1e-4f) bad++;
+                    }
+        }
+    }
+    CHECK(bad == 0);
+
+    vector<int> border;
+    t.borderPoints(border);
+    CHECK(border.size() + (k + 1) * (k + 1) == t.chunks[0].vertices.size());
+
+    TerrainView view;
+    vector<ChunkDraw> draws;
+    view.set(Vec3(30, 20, -10), Vec3(0, -.3f, 1).getNormalized(), Vec3(0, 1, 0), 60, 1.5f, .1f, 1000, 768);
+    t.select(view, draws);
+    CHECK(!draws.empty());
+    int coarse = 0;
+    for (int i = 0; i < draws.size(); i++) coarse += draws[i].level > 0;
+    CHECK(coarse > 0);
+    view.set(Vec3(30, 20, -10), Vec3(0, 0, -1), Vec3(0, 1, 0), 60, 1.5f, .1f, 1000, 768);
+    t.select(view, draws);
+    CHECK(draws.empty());
+}
+
+// the collider follows the surface away from the ridge, and pushes
+// particles below it back up, bouncing off it
+//
+static void testCollider(const Octree &octree) {
+    TerrainCollider collider;
+    collider.create(octree, 256);
+    float worst = 0;
+    for (int i = 10; i < 60; i += 7) {
+        for (int j = 10; j < 140; j += 11) {
+            float h;
+            CHECK(collider.height(i * .4f, j * .4f, h));
+            worst = max(worst, fabsf(h - terrainHeight(i, j, GridSize)));
+        }
+    }
+    CHECK(worst < .1f);
+    float h;
+    CHECK(!collider.height(-50, -50, h));
+
+    vector<Particle> particles(100);
+    for (int k = 0; k < particles.size(); k++) {
+        int i = 10 + k % 50, j = 10 + k / 2;
+        particles[k].position.set(i * .4f, terrainHeight(i, j, GridSize) - .5f, j * .4f);
+        particles[k].velocity.set(0, -3, 0);
+    }
+    particles[0].position.y += 10;
+    CHECK(collider.collide(particles) == 99);
+    int bad = 0;
+    for (int k = 1; k < particles.size(); k++) {
+        collider.height(particles[k].position.x, particles[k].position.z, h);
+        Vec3 n = collider.normal(particles[k].position.x, particles[k].position.z);
+        if (particles[k].position.y < h - 1e-3f || particles[k].velocity.dot(n) <= 0) bad++;
+    }
+    CHECK(bad == 0);
+}
+
+// the reader takes every face form and triangulates polygons as fans
+//
+static void testObj(const Mesh &mesh) {
+    CHECK(writeObj("terrain.obj", mesh));
+    Mesh parsed;
+    CHECK(loadObj("terrain.obj", parsed));
+    CHECK(parsed.getNumVertices() == mesh.getNumVertices());
+    CHECK(parsed.indices == mesh.indices);
+    CHECK(parsed.vertices.size() == mesh.vertices.size() &&
+          parsed.vertices[1234].distance(mesh.vertices[1234]) < 1e-5f);
+
+    FILE *fp = fopen("forms.obj", "w");
+    fprintf(fp, "# comment\nv 0 0 0\nv 1 0 0\nv 1 0 1\nv 0 0 1\nvt 0 0\nvn 0 1 0\n");
+    fprintf(fp, "f 1/1 2/1 3/1\nf 1//1 3//1 4//1\nf -4/1/1 -3/1/1 -2/1/1 -1/1/1\n");
+    fclose(fp);
+    Mesh forms;
+    CHECK(loadObj("forms.obj", forms));
+    unsigned int expected[] = { 0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 2, 3 };
+    CHECK(forms.indices == vector<unsigned int>(expected, expected + 12));
+    CHECK(!loadObj("missing.obj", forms));
+}
+
+// the binary file loads back the mesh testObj() parsed, only for the
+// source it was saved from, and never truncated
+//
+static void testTerrainFile() {
+    Mesh parsed, loaded;
+    CHECK(loadObj("terrain.obj", parsed));
+    CHECK(saveTerrainFile("terrain.obj.mesh", parsed, "terrain.obj"));
+    CHECK(loadTerrainFile("terrain.obj.mesh", loaded, "terrain.obj"));
+    CHECK(loaded.indices == parsed.indices);
+    CHECK(loaded.vertices.size() == parsed.vertices.size() &&
+          memcmp(&loaded.vertices[0], &parsed.vertices[0], parsed.vertices.size() * sizeof(Vec3)) == 0);
+
+    // an edited source makes the file stale, though it still loads alone
+    //
+    FILE *fp = fopen("terrain.obj", "a");
+    fprintf(fp, "\n");
+    fclose(fp);
+    CHECK(!loadTerrainFile("terrain.obj.mesh", loaded, "terrain.obj"));
+    CHECK(loadTerrainFile("terrain.obj.mesh", loaded));
+
+    CHECK(truncate("terrain.obj.mesh", 1000) == 0);
+    CHECK(!loadTerrainFile("terrain.obj.mesh", loaded));
+    remove("terrain.obj.mesh");
+}
+
+// a saved bake loads back for the same grid and settings only, and
+// shades every chunk vertex
+//
+static void testBake(const Octree &octree, TerrainChunks &grid) {
+    TerrainBake bake;
+    CHECK(bake.bake(octree, grid));
+    CHECK(bake.ao.size() == grid.nx * grid.nz);
+    int lit = 0, shadowed = 0;
+    for (int i = 0; i < bake.sunVisible.size(); i++) {
+        lit += bake.sunVisible[i] == 255;
+        shadowed += bake.sunVisible[i] == 0;
+    }
+    CHECK(lit > 0 && shadowed > 0);
+    CHECK(bake.save("terrain.bake"));
+
+    TerrainBake loaded;
+    CHECK(loaded.load("terrain.bake", grid));
+    CHECK(loaded.ao == bake.ao && loaded.sunVisible == bake.sunVisible);
+    loaded.rays = bake.rays / 2;
+    CHECK(!loaded.load("terrain.bake", grid));
+
+    // each skirt vertex takes the shade of the border point above it
+    //
+    bake.apply(grid);
+    vector<int> border;
+    grid.borderPoints(border);
+    int n = grid.chunkCells + 1, bad = 0;
+    for (int c = 0; c < grid.chunks.size(); c++) {
+        const TerrainChunk &chunk = grid.chunks[c];
+        if (chunk.shade.size() != chunk.vertices.size()) {
+            bad++;
+            continue;
+        }
+        for (int i = 0; i < chunk.shade.size(); i++)
+            if (chunk.shade[i] < 0 || chunk.shade[i] > 1) bad++;
+        for (int k = 0; k < border.size(); k++) {
+            const Vec3 &top = chunk.vertices[border[k]], &skirt = chunk.vertices[n * n + k];
+            if (skirt.x != top.x || skirt.z != top.z || chunk.shade[n * n + k] != chunk.shade[border[k]]) bad++;
+        }
+    }
+    CHECK(bad == 0);
+}
+
+// the loader builds the same height field as a synchronous build from
+// the OBJ testObj() wrote (to its six decimals), saving the binary cache
+// next to it, and bakes without touching the chunks; it fails cleanly on
+// a missing file and cancel() stops it promptly
+//
+static void testLoader(const Octree &expected) {
+    TerrainCollider reference;
+    reference.create(expected, 256);
+
+    Octree octree;
+    TerrainCollider collider;
+    TerrainChunks chunks;
+    TerrainBake bake;
+    TerrainLoader loader;
+    loader.start("terrain.obj", octree, collider, 7, 256, &chunks, 0, &bake);
+    loader.wait();
+    CHECK(loader.isDone() && loader.isReady() && loader.areChunksReady());
+    CHECK(collider.isReady());
+    CHECK(chunks.isReady());
+    Mesh cached;
+    CHECK(loadTerrainFile("terrain.obj.mesh", cached, "terrain.obj"));
+    remove("terrain.obj.mesh");
+
+    // the lighting is left for the caller to apply
+    //
+    CHECK(bake.isReady());
+    CHECK(chunks.chunks[0].shade.empty());
+    remove("terrain.obj.bake");
+    int bad = 0;
+    for (int i = 0; i < GridSize; i += 3) {
+        for (int j = 0; j < GridSize; j += 5) {
+            float a, b;
+            bool hitA = reference.height(i * .4f, j * .4f, a), hitB = collider.height(i * .4f, j * .4f, b);
+            if (hitA != hitB || (hitA && fabsf(a - b) > 1e-3f)) bad++;
+        }
+    }
+    CHECK(bad == 0);
+
+    Octree missingTree;
+    TerrainCollider missingCollider;
+    TerrainLoader missing;
+    missing.start("missing.obj", missingTree, missingCollider);
+    missing.wait();
+    CHECK(missing.getStage() == TerrainFailed);
+    CHECK(!missingCollider.isReady());
+
+    // cancelled a few milliseconds in, the job stops between stages or
+    // within the parse
+    //
+    Octree cancelledTree;
+    TerrainCollider cancelledCollider;
+    TerrainChunks cancelledChunks;
+    TerrainLoader cancelled;
+    cancelled.start("terrain.obj", cancelledTree, cancelledCollider, 7, 256, &cancelledChunks);
+    this_thread::sleep_for(chrono::milliseconds(5));
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cancelled.cancel();
+    double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    CHECK(cancelled.isDone());
+    CHECK(cancelled.getStage() == TerrainCancelled || cancelled.getStage() == TerrainReady);
+    CHECK(millis < 500);
+    remove("terrain.obj.mesh");
+}
+
+// height of chunk c drawn at level l over grid position (x, z), or false
+// where that level draws nothing
+//
+static bool levelHeight(const TerrainChunks &t, int l, float x, float z, float &h) {
+    int s = 1 << l, k = t.chunkCells, n = k + 1;
+    int gi = min(t.nx - 2, max(0, (int)floor(x))), gj = min(t.nz - 2, max(0, (int)floor(z)));
+    int cx = gi / k, cz = gj / k;
+    int i = (gi - cx * k) / s * s, j = (gj - cz * k) / s * s;
+    int bi = cx * k + i, bj = cz * k + j;
+    float fu = (x - bi) / s, fv = (z - bj) / s;
+    const TerrainChunk &chunk = t.chunks[cz * t.chunksX + cx];
+    float ha = chunk.vertices[j * n + i].y, hb = chunk.vertices[j * n + i + s].y;
+    float hc = chunk.vertices[(j + s) * n + i].y, hd = chunk.vertices[(j + s) * n + i + s].y;
+    if (fu + fv <= 1) {
+        if (!t.isCovered(bi, bj) || !t.isCovered(bi + s, bj) || !t.isCovered(bi, bj + s)) return false;
+        h = ha + fu * (hb - ha) + fv * (hc - ha);
+    } else {
+        if (!t.isCovered(bi + s, bj) || !t.isCovered(bi, bj + s) || !t.isCovered(bi + s, bj + s)) return false;
+        h = hd + (1 - fu) * (hc - hd) + (1 - fv) * (hb - hd);
+    }
+    return true;
+}
+
+// a grid coarser than the mesh loses detail between its points: every
+// level of every chunk, the full one included, stays within its error of
+// each mesh vertex it draws over
+//
+static void testSourceError(const TerrainChunks &t, const Mesh &mesh) {
+    int bad = 0;
+    float resampled = 0;
+    for (int v = 0; v < mesh.getNumVertices(); v++) {
+        const Vec3 &p = mesh.getVertex(v);
+        float x = (p.x - t.x0) / t.cellSize, z = (p.z - t.z0) / t.cellSize;
+        int c = min(t.nz - 2, max(0, (int)floor(z))) / t.chunkCells * t.chunksX +
+                min(t.nx - 2, max(0, (int)floor(x))) / t.chunkCells;
+        for (int l = 0; l < t.levels; l++) {
+            float h;
+            if (!levelHeight(t, l, x, z, h)) continue;
+            if (fabs(p.y - h) > t.chunks[c].errors[l] + 1e-4f) bad++;
+            if (l == 0) resampled = max(resampled, (float)fabs(p.y - h));
+        }
+    }
+    CHECK(bad == 0);
+    CHECK(resampled > .01f);
+}
+
+int main() {
+    Mesh mesh;
+    heightField(mesh, GridSize);
+    Octree octree;
+    octree.create(mesh, 7);
+    TerrainChunks grid;
+    grid.create(mesh, 128, 32);
+
+    testChunks(grid);
+    testSourceError(grid, mesh);
+    testCollider(octree);
+    testObj(mesh);
+    testTerrainFile();
+    testBake(octree, grid);
+    testLoader(octree);
+    return checkResult("TerrainTests");
+}
@@ -0,0 +1,49 @@
+#include "Check.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+// every index runs exactly once, whatever the grain
+//
+static void testCoverage() {
+    ThreadPool pool(3);
+    for (int grain = 1; grain <= 1024; grain *= 8) {
+        vector<atomic<int> > hits(5000);
+        for (int i = 0; i < hits.size(); i++) hits[i] = 0;
+        pool.parallelFor(hits.size(), [&](int begin, int end) {
+            for (int i = begin; i < end; i++) hits[i]++;
+        }, grain);
+        int bad = 0;
+        for (int i = 0; i < hits.size(); i++) bad += hits[i] != 1;
+        CHECK(bad == 0);
+    }
+}
+
+// a parallelFor inside a job runs inline, also on the calling thread
+// (which used to deadlock waiting for the job it was part of).  The
+// workers are slowed down so the caller takes some chunks itself.
+//
+static void testNested() {
+    ThreadPool pool(4);
+    atomic<int> total(0), callerChunks(0);
+    thread::id caller = this_thread::get_id();
+    pool.parallelFor(64, [&](int begin, int end) {
+        if (this_thread::get_id() == caller) callerChunks++;
+        else this_thread::sleep_for(chrono::milliseconds(2));
+        for (int i = begin; i < end; i++) {
+            pool.parallelFor(100, [&](int b, int e) { total += e - b; }, 10);
+        }
+    }, 1);
+    CHECK(total == 6400);
+    CHECK(callerChunks > 0);
+}
+
+int main() {
+    testCoverage();
+    testNested();
+    return checkResult("ThreadPoolTests");
+}